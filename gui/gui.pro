@@ -21,6 +21,23 @@ SOURCES +=                              \
     ../src/nrrlsdiagramwindow.cpp       \
     ../src/nrrlslogcategory.cpp         \
     ../src/nrrlscalc.cpp                \
+    ../src/nrrlsatmosphere.cpp          \
+    ../src/nrrlsband.cpp                \
+    ../src/nrrlsbudget.cpp              \
+    ../src/nrrlschain.cpp               \
+    ../src/nrrlscoarse.cpp              \
+    ../src/nrrlsdiffraction.cpp         \
+    ../src/nrrlsheightmap.cpp           \
+    ../src/nrrlsheights.cpp             \
+    ../src/nrrlsinverse.cpp             \
+    ../src/nrrlsmontecarlo.cpp          \
+    ../src/nrrlsoutage.cpp              \
+    ../src/nrrlsrefraction.cpp          \
+    ../src/nrrlsseries.cpp              \
+    ../src/nrrlsstock.cpp               \
+    ../src/nrrlskernel.cpp              \
+    ../src/nrrlssimd.cpp                \
+    ../src/nrrlssweep.cpp               \
     ../qcustomplot/qcustomplot.cpp      \
     ../src/nrrlsfirststationwidget.cpp  \
     ../src/nrrlssecondstationwidget.cpp
@@ -32,6 +49,26 @@ HEADERS +=                              \
     ../src/nrrlsdiagramwindow.h         \
     ../src/nrrlslogcategory.h           \
     ../src/nrrlscalc.h                  \
+    ../src/nrrlsatmosphere.h            \
+    ../src/nrrlsband.h                  \
+    ../src/nrrlsbudget.h                \
+    ../src/nrrlschain.h                 \
+    ../src/nrrlscoarse.h                \
+    ../src/nrrlsdiffraction.h           \
+    ../src/nrrlsdual.h                  \
+    ../src/nrrlsheightmap.h             \
+    ../src/nrrlsheights.h               \
+    ../src/nrrlsinterval.h              \
+    ../src/nrrlsinverse.h               \
+    ../src/nrrlsmontecarlo.h            \
+    ../src/nrrlsoutage.h                \
+    ../src/nrrlspipeline.h              \
+    ../src/nrrlsrefraction.h            \
+    ../src/nrrlsseries.h                \
+    ../src/nrrlsstock.h                 \
+    ../src/nrrlskernel.h                \
+    ../src/nrrlssimd.h                  \
+    ../src/nrrlssweep.h                 \
     ../qcustomplot/qcustomplot.h        \
     ../src/nrrlsfirststationwidget.h    \
     ../src/nrrlssecondstationwidget.h
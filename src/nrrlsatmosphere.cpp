@@ -0,0 +1,526 @@
+#include "nrrlsatmosphere.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Atmosphere {
+
+namespace {
+
+/**
+ * Спектральная линия (Рек. МСЭ-R P.676, Приложение 1, табл. 1 и 2)
+ */
+struct Line {
+  double f0;  ///< Частота линии (в ГГц)
+  double c1, c2, c3, c4, c5, c6;
+};
+
+/**
+ * Линии кислорода: f0, a1 ... a6
+ */
+const Line oxygen_lines[] = {
+    {50.474214, 0.975, 9.651, 6.690, 0.0, 2.566, 6.850},
+    {50.987745, 2.529, 8.653, 7.170, 0.0, 2.246, 6.800},
+    {51.503360, 6.193, 7.709, 7.640, 0.0, 1.947, 6.729},
+    {52.021429, 14.320, 6.819, 8.110, 0.0, 1.667, 6.640},
+    {52.542418, 31.240, 5.983, 8.580, 0.0, 1.388, 6.526},
+    {53.066934, 64.290, 5.201, 9.060, 0.0, 1.349, 6.206},
+    {53.595775, 124.600, 4.474, 9.550, 0.0, 2.227, 5.085},
+    {54.130025, 227.300, 3.800, 9.960, 0.0, 3.170, 3.750},
+    {54.671180, 389.700, 3.182, 10.370, 0.0, 3.558, 2.654},
+    {55.221384, 627.100, 2.618, 10.890, 0.0, 2.560, 2.952},
+    {55.783815, 945.300, 2.109, 11.340, 0.0, -1.172, 6.135},
+    {56.264774, 543.400, 0.014, 17.030, 0.0, 3.525, -0.978},
+    {56.363399, 1331.800, 1.654, 11.890, 0.0, -2.378, 6.547},
+    {56.968211, 1746.600, 1.255, 12.230, 0.0, -3.545, 6.451},
+    {57.612486, 2120.100, 0.910, 12.620, 0.0, -5.416, 6.056},
+    {58.323877, 2363.700, 0.621, 12.950, 0.0, -1.932, 0.436},
+    {58.446588, 1442.100, 0.083, 14.910, 0.0, 6.768, -1.273},
+    {59.164204, 2379.900, 0.387, 13.530, 0.0, -6.561, 2.309},
+    {59.590983, 2090.700, 0.207, 14.080, 0.0, 6.957, -0.776},
+    {60.306056, 2103.400, 0.207, 14.150, 0.0, -6.395, 0.699},
+    {60.434778, 2438.000, 0.386, 13.390, 0.0, 6.342, -2.825},
+    {61.150562, 2479.500, 0.621, 12.920, 0.0, 1.014, -0.584},
+    {61.800158, 2275.900, 0.910, 12.630, 0.0, 5.014, -6.619},
+    {62.411220, 1915.400, 1.255, 12.170, 0.0, 3.029, -6.759},
+    {62.486253, 1503.000, 0.083, 15.130, 0.0, -4.499, 0.844},
+    {62.997984, 1490.200, 1.654, 11.740, 0.0, 1.856, -6.675},
+    {63.568526, 1078.000, 2.108, 11.340, 0.0, 0.658, -6.139},
+    {64.127775, 728.700, 2.617, 10.880, 0.0, -3.036, -2.895},
+    {64.678910, 461.300, 3.181, 10.380, 0.0, -3.968, -2.590},
+    {65.224078, 274.000, 3.800, 9.960, 0.0, -3.528, -3.680},
+    {65.764779, 153.000, 4.473, 9.550, 0.0, -2.548, -5.002},
+    {66.302096, 80.400, 5.200, 9.060, 0.0, -1.660, -6.091},
+    {66.836834, 39.800, 5.982, 8.580, 0.0, -1.680, -6.393},
+    {67.369601, 18.560, 6.818, 8.110, 0.0, -1.956, -6.475},
+    {67.900868, 8.172, 7.708, 7.640, 0.0, -2.216, -6.545},
+    {68.431006, 3.397, 8.652, 7.170, 0.0, -2.492, -6.600},
+    {68.960312, 1.334, 9.650, 6.690, 0.0, -2.773, -6.650},
+    {118.750334, 940.300, 0.010, 16.640, 0.0, -0.439, 0.079},
+    {368.498246, 67.400, 0.048, 16.400, 0.0, 0.000, 0.000},
+    {424.763020, 637.700, 0.044, 16.400, 0.0, 0.000, 0.000},
+    {487.249273, 237.400, 0.049, 16.000, 0.0, 0.000, 0.000},
+    {715.392902, 98.100, 0.145, 16.000, 0.0, 0.000, 0.000},
+    {773.839490, 572.300, 0.141, 16.200, 0.0, 0.000, 0.000},
+    {834.145546, 183.100, 0.145, 14.700, 0.0, 0.000, 0.000}};
+
+/**
+ * Линии водяного пара: f0, b1 ... b6
+ */
+const Line water_lines[] = {
+    {22.235080, 0.1079, 2.144, 26.38, 0.76, 5.087, 1.00},
+    {67.803960, 0.0011, 8.732, 28.58, 0.69, 4.930, 0.82},
+    {119.995940, 0.0007, 8.353, 29.48, 0.70, 4.780, 0.79},
+    {183.310087, 2.273, 0.668, 29.06, 0.77, 5.022, 0.85},
+    {321.225630, 0.0470, 6.179, 24.04, 0.67, 4.398, 0.54},
+    {325.152888, 1.514, 1.541, 28.23, 0.64, 4.893, 0.74},
+    {336.227764, 0.0010, 9.825, 26.93, 0.69, 4.740, 0.61},
+    {380.197353, 11.67, 1.048, 28.11, 0.54, 5.063, 0.89},
+    {390.134508, 0.0045, 7.347, 21.52, 0.63, 4.810, 0.55},
+    {437.346667, 0.0632, 5.048, 18.45, 0.60, 4.230, 0.48},
+    {439.150807, 0.9098, 3.595, 20.07, 0.63, 4.483, 0.52},
+    {443.018343, 0.1920, 5.048, 15.55, 0.60, 5.083, 0.50},
+    {448.001085, 10.41, 1.405, 25.64, 0.66, 5.028, 0.67},
+    {470.888999, 0.3254, 3.597, 21.34, 0.66, 4.506, 0.65},
+    {474.689092, 1.260, 2.379, 23.20, 0.65, 4.804, 0.64},
+    {488.490108, 0.2529, 2.852, 25.86, 0.69, 5.201, 0.72},
+    {503.568532, 0.0372, 6.731, 16.12, 0.61, 3.980, 0.43},
+    {504.482692, 0.0124, 6.731, 16.12, 0.61, 4.010, 0.45},
+    {547.676440, 0.9785, 0.158, 26.00, 0.70, 4.500, 1.00},
+    {552.020960, 0.1840, 0.158, 26.00, 0.70, 4.500, 1.00},
+    {556.935985, 497.0, 0.159, 30.86, 0.69, 4.552, 1.00},
+    {620.700807, 5.015, 2.391, 24.38, 0.71, 4.856, 0.68},
+    {645.766085, 0.0067, 8.633, 18.00, 0.60, 4.000, 0.50},
+    {658.005280, 0.2732, 7.816, 32.10, 0.69, 4.140, 1.00},
+    {752.033113, 243.4, 0.396, 30.86, 0.68, 4.352, 0.84},
+    {841.051732, 0.0134, 8.177, 15.90, 0.33, 5.760, 0.45},
+    {859.965698, 0.1325, 8.055, 30.60, 0.68, 4.090, 0.84},
+    {899.303175, 0.0547, 7.914, 29.85, 0.68, 4.530, 0.90},
+    {902.611085, 0.0386, 8.429, 28.65, 0.70, 5.100, 0.95},
+    {906.205957, 0.1836, 5.110, 24.08, 0.70, 4.700, 0.53},
+    {916.171582, 8.400, 1.441, 26.73, 0.70, 5.150, 0.78},
+    {923.112692, 0.0079, 10.293, 29.00, 0.70, 5.000, 0.80},
+    {970.315022, 9.009, 1.919, 25.50, 0.64, 4.940, 0.67},
+    {987.926764, 134.6, 0.257, 29.85, 0.68, 4.550, 0.90},
+    {1780.000000, 17506., 0.952, 196.3, 2.00, 24.15, 5.00}};
+
+const int oxygen_count = sizeof(oxygen_lines) / sizeof(Line);
+const int water_count = sizeof(water_lines) / sizeof(Line);
+
+/**
+ * Параметры линии, зависящие только от состояния атмосферы
+ */
+struct Shape {
+  double f0;
+  double s;      ///< Интенсивность
+  double width;  ///< Ширина
+  double delta;  ///< Поправка на интерференцию
+};
+
+/**
+ * Спектр поглощения при заданном состоянии атмосферы. Параметры линий
+ * рассчитываются один раз, после чего затухание на любой частоте находится
+ * суммированием формы линий
+ */
+class Spectrum {
+ public:
+  explicit Spectrum(const Conditions &c) {
+    const double t = c.temperature + 273.15;
+    _theta = 300 / t;
+    _e = c.humidity * t / 216.7;
+    _p = qMax(c.pressure - _e, 0.0);
+
+    for (int i = 0; i < oxygen_count; ++i) {
+      const Line &l = oxygen_lines[i];
+      Shape s;
+      s.f0 = l.f0;
+      s.s = l.c1 * 1e-7 * _p * qPow(_theta, 3) * qExp(l.c2 * (1 - _theta));
+      s.width = l.c3 * 1e-4 *
+                (_p * qPow(_theta, .8 - l.c4) + 1.1 * _e * _theta);
+      s.width = qSqrt(s.width * s.width + 2.25e-6);
+      s.delta = (l.c5 + l.c6 * _theta) * 1e-4 * (_p + _e) * qPow(_theta, .8);
+      _oxygen[i] = s;
+    }
+
+    for (int i = 0; i < water_count; ++i) {
+      const Line &l = water_lines[i];
+      Shape s;
+      s.f0 = l.f0;
+      s.s = l.c1 * 1e-1 * _e * qPow(_theta, 3.5) * qExp(l.c2 * (1 - _theta));
+      s.width = l.c3 * 1e-4 *
+                (_p * qPow(_theta, l.c4) + l.c5 * _e * qPow(_theta, l.c6));
+      s.width = .535 * s.width +
+                qSqrt(.217 * s.width * s.width +
+                      2.1316e-12 * l.f0 * l.f0 / _theta);
+      s.delta = 0;
+      _water[i] = s;
+    }
+
+    _d = 5.6e-4 * (_p + _e) * qPow(_theta, .8);
+  }
+
+  Gamma operator()(double f) const {
+    double n_oxygen = 0, n_water = 0;
+    for (int i = 0; i < oxygen_count; ++i)
+      n_oxygen += _oxygen[i].s * _factor(_oxygen[i], f);
+    for (int i = 0; i < water_count; ++i)
+      n_water += _water[i].s * _factor(_water[i], f);
+
+    // Непрерывный спектр сухого воздуха
+    n_oxygen +=
+        f * _p * _theta * _theta *
+        (6.14e-5 / (_d * (1 + qPow(f / _d, 2))) +
+         1.4e-12 * _p * qPow(_theta, 1.5) / (1 + 1.9e-5 * qPow(f, 1.5)));
+
+    Gamma g;
+    g.oxygen = .182 * f * n_oxygen;
+    g.water = .182 * f * n_water;
+    return g;
+  }
+
+ private:
+  /**
+   * Форм-фактор линии
+   */
+  static double _factor(const Shape &s, double f) {
+    const double w2 = s.width * s.width;
+    return f / s.f0 *
+           ((s.width - s.delta * (s.f0 - f)) / (qPow(s.f0 - f, 2) + w2) +
+            (s.width - s.delta * (s.f0 + f)) / (qPow(s.f0 + f, 2) + w2));
+  }
+
+ private:
+  double _theta;  ///< 300 / T
+  double _e;      ///< Давление водяного пара (в гПа)
+  double _p;      ///< Давление сухого воздуха (в гПа)
+  double _d;      ///< Параметр ширины непрерывного спектра
+  Shape _oxygen[oxygen_count];
+  Shape _water[water_count];
+};
+
+}  // namespace
+
+Gamma lineByLine(double f, const Conditions &c) { return Spectrum(c)(f); }
+
+const Table::Axis Table::f_axis = {-2, 1.0 / 64, 257};
+const Table::Axis Table::t_axis = {-50, 10, 11};
+const Table::Axis Table::p_axis = {500, 100, 7};
+const Table::Axis Table::h_axis = {0, 5, 7};
+
+int Table::Axis::locate(double v, double &frac) const {
+  const double u = qBound(0.0, (v - min) / step, n - 1.0);
+  const int i = qMin(static_cast<int>(u), n - 2);
+  frac = u - i;
+  return i;
+}
+
+const Table &Table::instance() {
+  static const Table table;
+  return table;
+}
+
+Table::Table() {
+  const int size = f_axis.n * t_axis.n * p_axis.n * h_axis.n;
+  _oxygen.resize(size);
+  _water.resize(size);
+
+  QVector<double> f(f_axis.n);
+  for (int i = 0; i < f_axis.n; ++i) f[i] = qPow(10, f_axis.value(i));
+
+  for (int h = 0; h < h_axis.n; ++h)
+    for (int p = 0; p < p_axis.n; ++p)
+      for (int t = 0; t < t_axis.n; ++t) {
+        Conditions c;
+        c.temperature = t_axis.value(t);
+        c.pressure = p_axis.value(p);
+        c.humidity = h_axis.value(h);
+        const Spectrum spectrum(c);
+
+        const int base = _index(0, t, p, h);
+        for (int i = 0; i < f_axis.n; ++i) {
+          const Gamma g = spectrum(f[i]);
+          _oxygen[base + i] = g.oxygen;
+          _water[base + i] = g.water;
+        }
+      }
+}
+
+Gamma Table::gamma(double f, const Conditions &c) const {
+  double w[4];
+  const int fi = f_axis.locate(log10(qMax(f, 1e-6)), w[0]);
+  const int ti = t_axis.locate(c.temperature, w[1]);
+  const int pi = p_axis.locate(c.pressure, w[2]);
+  const int hi = h_axis.locate(c.humidity, w[3]);
+
+  Gamma g;
+  for (int corner = 0; corner < 16; ++corner) {
+    double k = 1;
+    for (int d = 0; d < 4; ++d) k *= (corner >> d & 1) ? w[d] : 1 - w[d];
+    if (k == 0) continue;
+
+    const int i = _index(fi + (corner & 1), ti + (corner >> 1 & 1),
+                         pi + (corner >> 2 & 1), hi + (corner >> 3 & 1));
+    g.oxygen += k * _oxygen[i];
+    g.water += k * _water[i];
+  }
+  return g;
+}
+
+Table::Slice Table::slice(double f) const {
+  double w;
+  const int fi = f_axis.locate(log10(qMax(f, 1e-6)), w);
+
+  Slice s;
+  s._total.resize(t_axis.n * p_axis.n * h_axis.n);
+  for (int h = 0, k = 0; h < h_axis.n; ++h)
+    for (int p = 0; p < p_axis.n; ++p)
+      for (int t = 0; t < t_axis.n; ++t, ++k) {
+        const int i = _index(fi, t, p, h);
+        s._total[k] = (1 - w) * (_oxygen[i] + _water[i]) +
+                      w * (_oxygen[i + 1] + _water[i + 1]);
+      }
+  return s;
+}
+
+double Table::Slice::operator()(const Conditions &c) const {
+  double w[3];
+  const int ti = t_axis.locate(c.temperature, w[0]);
+  const int pi = p_axis.locate(c.pressure, w[1]);
+  const int hi = h_axis.locate(c.humidity, w[2]);
+  const double *v = _total.constData() + (hi * p_axis.n + pi) * t_axis.n + ti;
+
+  double g = 0;
+  for (int corner = 0; corner < 8; ++corner) {
+    double k = 1;
+    for (int d = 0; d < 3; ++d) k *= (corner >> d & 1) ? w[d] : 1 - w[d];
+    g += k * v[(corner >> 2 & 1) * p_axis.n * t_axis.n +
+               (corner >> 1 & 1) * t_axis.n + (corner & 1)];
+  }
+  return g;
+}
+
+namespace Rain {
+
+namespace {
+
+/**
+ * Аппроксимация коэффициента суммой гауссиан от lg f
+ * (Рек. МСЭ-R P.838, табл. 1-4)
+ */
+struct Fit {
+  int n;
+  double a[5], b[5], c[5];
+  double m, c0;
+
+  double operator()(double lf) const {
+    double v = m * lf + c0;
+    for (int j = 0; j < n; ++j) v += a[j] * qExp(-qPow((lf - b[j]) / c[j], 2));
+    return v;
+  }
+};
+
+const Fit k_h = {4,
+                 {-5.33980, -0.35351, -0.23789, -0.94158},
+                 {-0.10008, 1.26970, 0.86036, 0.64552},
+                 {1.13098, 0.45400, 0.15354, 0.16817},
+                 -0.18961,
+                 0.71147};
+
+const Fit k_v = {4,
+                 {-3.80595, -3.44965, -0.39902, 0.50167},
+                 {0.56934, -0.22911, 0.73042, 1.07319},
+                 {0.81061, 0.51059, 0.11899, 0.27195},
+                 -0.16398,
+                 0.63297};
+
+const Fit alpha_h = {5,
+                     {-0.14318, 0.29591, 0.32177, -5.37610, 16.1721},
+                     {1.82442, 0.77564, 0.63773, -0.96230, -3.29980},
+                     {-0.55187, 0.19822, 0.13164, 1.47828, 3.43990},
+                     0.67849,
+                     -1.95537};
+
+const Fit alpha_v = {5,
+                     {-0.07771, 0.56727, -0.20238, -48.2991, 48.5833},
+                     {2.33840, 0.95545, 1.14520, 0.791669, 0.791459},
+                     {-0.76284, 0.54039, 0.26809, 0.116226, 0.116479},
+                     -0.053739,
+                     0.83433};
+
+/**
+ * Границы аппроксимации при lg f, заданном интервалом
+ */
+IA::Interval fit(const Fit &a, const IA::Interval &lf) {
+  IA::Interval v = a.m * lf + a.c0;
+  for (int j = 0; j < a.n; ++j) {
+    const IA::Interval u = qAbs((lf - a.b[j]) / a.c[j]);
+    v += a.a[j] * qExp(-(u * u));
+  }
+  return v;
+}
+
+const double rain_part = .002;  ///< Ширина части отрезка по lg f
+const int rain_parts = 256;     ///< Наибольшее число частей отрезка
+
+/**
+ * Показатель степени в рекомендации для частоты (в ГГц), от которого
+ * зависит пересчет затухания на проценты времени
+ */
+double c0(double f) {
+  return f >= 10 ? .12 + .4 * log10(qPow(f / 10, .8)) : .12;
+}
+
+}  // namespace
+
+Coef coef(double f, double tau) {
+  const double lf = log10(qBound(1.0, f, 1000.0));
+  const double kh = qPow(10, k_h(lf)), kv = qPow(10, k_v(lf));
+  const double ah = alpha_h(lf), av = alpha_v(lf);
+  const double c = qCos(2 * qDegreesToRadians(tau));
+
+  Coef r;
+  r.k = (kh + kv + (kh - kv) * c) / 2;
+  r.alpha = (kh * ah + kv * av + (kh * ah - kv * av) * c) / (2 * r.k);
+  return r;
+}
+
+Batch::Batch(const QVector<Link> &links) {
+  const int n = links.size();
+  _a001.resize(n);
+  _c1.resize(n);
+  _c2.resize(n);
+  _c3.resize(n);
+
+  for (int j = 0; j < n; ++j) {
+    const Link &l = links[j];
+    const Coef k = coef(l.f, l.tau);
+    const double gamma = k.k * qPow(l.rate, k.alpha);
+
+    // Коэффициент уменьшения длины интервала
+    const double r =
+        1 / (.477 * qPow(l.length, .633) * qPow(l.rate, .073 * k.alpha) *
+                 qPow(l.f, .123) -
+             10.579 * (1 - qExp(-.024 * l.length)));
+    _a001[j] = gamma * l.length * (r > 0 ? qMin(r, 2.5) : 2.5);
+
+    const double c = c0(l.f);
+    _c1[j] = qPow(.07, c) * qPow(.12, 1 - c);
+    _c2[j] = (.855 * c + .546 * (1 - c)) * M_LN10;
+    _c3[j] = (.139 * c + .043 * (1 - c)) * M_LN10;
+  }
+}
+
+void Batch::attenuation(const QVector<double> &p, QVector<double> &a) const {
+  const int n = size();
+  a.resize(p.size() * n);
+
+  const double *a001 = _a001.constData(), *c1 = _c1.constData(),
+               *c2 = _c2.constData(), *c3 = _c3.constData();
+  double *out = a.data();
+
+  // A_p = A_0.01 * C1 * p ^ -(C2 + C3 * lg p)
+  for (int i = 0; i < p.size(); ++i, out += n) {
+    const double lp = log10(qBound(1e-3, p[i], 1.0));
+    for (int j = 0; j < n; ++j)
+      out[j] = a001[j] * c1[j] * std::exp(-(c2[j] + c3[j] * lp) * lp);
+  }
+}
+
+void Batch::percentage(const QVector<double> &a, QVector<double> &p) const {
+  const int n = size();
+  p.resize(n);
+
+  // lg p - корень уравнения C3 * lg^2 p + C2 * lg p + ln(a / A_0.01 / C1) = 0.
+  // Без дождя затухание нулевое при любом запасе, иначе процент
+  // ограничивается теми же пределами аппроксимации, что и в attenuation
+  for (int j = 0; j < n; ++j) {
+    if (_a001[j] <= 0) {
+      p[j] = 0;
+      continue;
+    }
+    if (a[j] <= 0) {
+      p[j] = 1;
+      continue;
+    }
+    const double l = qLn(a[j] / (_a001[j] * _c1[j]));
+    const double d = _c2[j] * _c2[j] - 4 * _c3[j] * l;
+    p[j] = d < 0 ? 1e-3
+                 : qBound(1e-3, qPow(10, (-_c2[j] + qSqrt(d)) / (2 * _c3[j])),
+                          1.0);
+  }
+}
+
+QVector<double> attenuation(const Link &link, const QVector<double> &p) {
+  QVector<double> a;
+  Batch(QVector<Link>(1, link)).attenuation(p, a);
+  return a;
+}
+
+IA::Interval attenuation(const Link &link, const IA::Interval &f, double p) {
+  if (!f.width()) {
+    Link l = link;
+    l.f = f.lo();
+    return attenuation(l, QVector<double>(1, p)).first();
+  }
+  if (link.rate <= 0) return 0;
+
+  const double c = qCos(2 * qDegreesToRadians(link.tau));
+  const double ln_rate = qLn(link.rate), l = link.length;
+
+  // Затухание, превышаемое 0,01% времени, на отрезке частот
+  auto a001 = [&](const IA::Interval &f) {
+    // Коэффициенты как в coef: веса поляризаций неотрицательны
+    const IA::Interval lf = log10(IA::Interval(qBound(1.0, f.lo(), 1000.0),
+                                               qBound(1.0, f.hi(), 1000.0)));
+    const IA::Interval kh = qExp(fit(k_h, lf) * M_LN10),
+                       kv = qExp(fit(k_v, lf) * M_LN10);
+    const IA::Interval ah = fit(alpha_h, lf), av = fit(alpha_v, lf);
+    const IA::Interval k = kh * ((1 + c) / 2) + kv * ((1 - c) / 2);
+    const IA::Interval w =
+        (kh * ah * ((1 + c) / 2) + kv * av * ((1 - c) / 2)) / k;
+
+    // alpha - взвешенное среднее ah и av и не выходит за их границы
+    const IA::Interval alpha(
+        qMax(w.lo(), qMin(ah.lo(), av.lo())),
+        qMin(w.hi(), qMax(ah.hi(), av.hi())));
+
+    // Коэффициент уменьшения длины интервала убывает с ростом знаменателя,
+    // при неположительном знаменателе он равен 2,5
+    const IA::Interval d =
+        .477 * qPow(l, .633) * qExp(.073 * ln_rate * alpha) *
+            qExp(.123 * qLn(f)) -
+        10.579 * (1 - qExp(-.024 * l));
+    const IA::Interval r(d.hi() > 0 ? qMin(1 / d.hi(), 2.5) : 2.5,
+                         d.lo() > 0 ? qMin(1 / d.lo(), 2.5) : 2.5);
+    return k * qExp(alpha * ln_rate) * l * r;
+  };
+
+  // Сумма гауссиан на широком отрезке оценивается грубо, поэтому отрезок
+  // делится на части, равные по логарифму частоты
+  const double lo = log10(f.lo()), hi = log10(f.hi());
+  const int parts = qBound(1, qCeil((hi - lo) / rain_part), rain_parts);
+  IA::Interval a = a001(IA::Interval(f.lo(), qPow(10, lo + (hi - lo) / parts)));
+  for (int i = 1; i < parts; ++i) {
+    const IA::Interval v = a001(IA::Interval(
+        qPow(10, lo + (hi - lo) * i / parts),
+        i + 1 < parts ? qPow(10, lo + (hi - lo) * (i + 1) / parts) : f.hi()));
+    a = IA::Interval(qMin(a.lo(), v.lo()), qMax(a.hi(), v.hi()));
+  }
+
+  // Логарифм множителя C1 * p ^ -(C2 + C3 * lg p) линеен по показателю C0,
+  // который не убывает с ростом частоты
+  const double lp = log10(qBound(1e-3, p, 1.0));
+  auto scale = [&](double c) {
+    return qPow(.07, c) * qPow(.12, 1 - c) *
+           std::exp(-((.855 * c + .546 * (1 - c)) +
+                      (.139 * c + .043 * (1 - c)) * lp) *
+                    lp * M_LN10);
+  };
+  const double s1 = scale(c0(f.lo())), s2 = scale(c0(f.hi()));
+  return a * IA::Interval(qMin(s1, s2), qMax(s1, s2));
+}
+
+}  // namespace Rain
+
+}  // namespace Atmosphere
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,222 @@
+#ifndef NRRLSATMOSPHERE_H
+#define NRRLSATMOSPHERE_H
+
+#include <QVector>
+#include <QtMath>
+
+#include "nrrlsinterval.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Atmosphere {
+
+/**
+ * Состояние атмосферы
+ */
+struct Conditions {
+  double temperature = 15;    ///< Температура (в градусах Цельсия)
+  double pressure = 1013.25;  ///< Атмосферное давление (в гПа)
+  double humidity = 7.5;      ///< Плотность водяного пара (в г/м3)
+};
+
+/**
+ * Погонное затухание в газах атмосферы (в дБ/км)
+ */
+struct Gamma {
+  double oxygen = 0;  ///< Затухание в кислороде
+  double water = 0;   ///< Затухание в водяном паре
+
+  double total() const { return oxygen + water; }
+};
+
+/**
+ * Функция строгого расчета погонного затухания по спектральным линиям
+ * кислорода и водяного пара (Рек. МСЭ-R P.676, Приложение 1)
+ * @param f       - частота (в ГГц)
+ * @param c       - состояние атмосферы
+ * @return Погонное затухание
+ */
+Gamma lineByLine(double f, const Conditions &c);
+
+/**
+ * Таблица погонного затухания на сетке частота x температура x давление x
+ * влажность. Строится один раз при первом обращении, затухание на
+ * промежуточных значениях находится полилинейной интерполяцией
+ */
+class Table {
+ public:
+  static const Table &instance();
+
+  /**
+   * Функция нахождения погонного затухания
+   * @param f       - частота (в ГГц), ограничивается пределами сетки
+   * @param c       - состояние атмосферы, ограничивается пределами сетки
+   * @return Погонное затухание
+   */
+  Gamma gamma(double f, const Conditions &c) const;
+
+  /**
+   * Сечение таблицы на одной частоте для расчета большого числа состояний
+   * атмосферы: на каждое состояние приходится интерполяция по трем осям
+   * вместо четырех
+   */
+  class Slice {
+   public:
+    /**
+     * Функция нахождения суммарного погонного затухания
+     * @param c       - состояние атмосферы, ограничивается пределами сетки
+     */
+    double operator()(const Conditions &c) const;
+
+   private:
+    friend class Table;
+    QVector<double> _total;
+  };
+
+  /**
+   * Функция построения сечения таблицы
+   * @param f       - частота (в ГГц), ограничивается пределами сетки
+   */
+  Slice slice(double f) const;
+
+  Table(Table const &) = delete;
+  Table &operator=(Table const &) = delete;
+
+ public:
+  /**
+   * Ось равномерной сетки
+   */
+  struct Axis {
+    double min;
+    double step;
+    int n;
+
+    double value(int i) const { return min + step * i; }
+
+    /**
+     * Функция нахождения узла слева от значения и доли до следующего узла
+     */
+    int locate(double v, double &frac) const;
+  };
+
+  static const Axis f_axis;  ///< Десятичный логарифм частоты (в ГГц)
+  static const Axis t_axis;  ///< Температура
+  static const Axis p_axis;  ///< Давление
+  static const Axis h_axis;  ///< Плотность водяного пара
+
+ private:
+  Table();
+
+  int _index(int f, int t, int p, int h) const {
+    return ((h * p_axis.n + p) * t_axis.n + t) * f_axis.n + f;
+  }
+
+ private:
+  QVector<double> _oxygen;
+  QVector<double> _water;
+};
+
+namespace Rain {
+
+/**
+ * Коэффициенты погонного затухания в дожде gamma = k * R ^ alpha
+ * (Рек. МСЭ-R P.838)
+ */
+struct Coef {
+  double k = 0;
+  double alpha = 0;
+};
+
+/**
+ * Функция расчета коэффициентов погонного затухания в дожде
+ * @param f       - частота (в ГГц), ограничивается пределами 1...1000 ГГц
+ * @param tau     - угол наклона поляризации к горизонту (в градусах):
+ *                  0 - горизонтальная, 90 - вертикальная, 45 - круговая
+ * @return Коэффициенты
+ */
+Coef coef(double f, double tau);
+
+/**
+ * Параметры интервала для расчета затухания в дожде
+ */
+struct Link {
+  double f;       ///< Частота (в ГГц)
+  double length;  ///< Длина интервала (в км)
+  double rate;    ///< Интенсивность дождя, превышаемая 0,01% времени (в мм/ч)
+  double tau;     ///< Угол наклона поляризации (в градусах)
+};
+
+/**
+ * Пакет интервалов. Параметры, не зависящие от процента времени,
+ * рассчитываются при построении и хранятся по массиву на каждый параметр,
+ * так что пересчет на проценты времени выполняется одним проходом по
+ * непрерывным массивам
+ */
+class Batch {
+ public:
+  explicit Batch(const QVector<Link> &links);
+
+  int size() const { return _a001.size(); }
+
+  /**
+   * Функция расчета затухания в дожде, превышаемого заданными процентами
+   * времени (Рек. МСЭ-R P.530)
+   * @param p       - проценты времени, ограничиваются пределами 0,001...1%
+   * @param a       - затухания (в дБ): a[i * size() + j] для процента i и
+   *                  интервала j
+   */
+  void attenuation(const QVector<double> &p, QVector<double> &a) const;
+
+  /**
+   * Функция расчета затухания в дожде на одном интервале пакета без
+   * выделения памяти
+   * @param j       - номер интервала
+   * @param p       - процент времени, ограничивается пределами 0,001...1%
+   * @return Затухание (в дБ)
+   */
+  double attenuation(int j, double p) const {
+    const double lp = log10(qBound(1e-3, p, 1.0));
+    return _a001[j] * _c1[j] * std::exp(-(_c2[j] + _c3[j] * lp) * lp);
+  }
+
+  /**
+   * Функция расчета процента времени, в течение которого затухание в дожде
+   * превышает заданное (обращение attenuation)
+   * @param a       - затухания (в дБ) по интервалам
+   * @param p       - проценты времени по интервалам в пределах 0,001...1%,
+   *                  0 - дождя нет
+   */
+  void percentage(const QVector<double> &a, QVector<double> &p) const;
+
+ private:
+  QVector<double> _a001;  ///< Затухание, превышаемое 0,01% времени
+  QVector<double> _c1, _c2, _c3;  ///< Коэффициенты пересчета на проценты
+};
+
+/**
+ * Функция расчета затухания в дожде на одном интервале
+ * @param link    - параметры интервала
+ * @param p       - проценты времени
+ * @return Затухания (в дБ) для каждого процента
+ */
+QVector<double> attenuation(const Link &link, const QVector<double> &p);
+
+/**
+ * Функция расчета границ затухания в дожде при частоте, заданной
+ * интервалом. Коэффициенты погонного затухания оцениваются интервальной
+ * арифметикой по аппроксимации, пересчет на процент времени монотонен по
+ * частоте и берется в концах интервала
+ * @param link    - параметры интервала, частота link.f не используется
+ * @param f       - частота (в ГГц)
+ * @param p       - процент времени, ограничивается пределами 0,001...1%
+ * @return Границы затухания (в дБ)
+ */
+IA::Interval attenuation(const Link &link, const IA::Interval &f, double p);
+
+}  // namespace Rain
+
+}  // namespace Atmosphere
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSATMOSPHERE_H
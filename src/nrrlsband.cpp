@@ -0,0 +1,113 @@
+#include "nrrlsband.h"
+#include "nrrlsbudget.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Band {
+
+QVector<double> grid(double begin, double end, double step) {
+  QVector<double> f;
+  if (step <= 0 || end < begin) return f;
+  const int n = static_cast<int>((end - begin) / step + 1e-9) + 1;
+  f.resize(n);
+  for (int i = 0; i < n; ++i) f[i] = begin + i * step;
+  return f;
+}
+
+Result evaluate(const Link &l, const QVector<double> &f,
+                const QVector<double> &stock) {
+  Result r;
+  const int m = f.size();
+  const int n = l.track.size();
+  r.f = f;
+  r.type.fill(0, m);
+  r.ws.fill(0, m);
+  r.wa.fill(0, m);
+  r.wp.fill(0, m);
+  r.wr.fill(0, m);
+  r.q.fill(0, m);
+  r.stock.fill(0, m);
+  if (!m || n < 2) return r;
+
+  QVector<double> lambda(m), s(m);  ///< Длины волн и корни из них
+  for (int j = 0; j < m; ++j) {
+    lambda[j] = 3e+8 / (f[j] * 1e+6);
+    s[j] = qSqrt(lambda[j]);
+  }
+
+  // Профиль рассчитывается для единичной длины волны, тогда для длины волны
+  // lambda критический просвет равен H_null * s, относительный - h_null / s
+  Kernel::Track t;
+  t.x = l.track.x;
+  t.y = l.track.y;
+  Kernel::Params p = l.params;
+  p.lambda = 1;
+  const Kernel::Extrema e = Kernel::profilePass(p, t);
+
+  // Интервал открыт, пока s не превышает минимума H / H_null, и полуоткрыт
+  // в вырожденном случае, если s превышает минимум по точкам с H > 0
+  double r_min = HUGE_VAL, r_pos = HUGE_VAL;
+  for (int i = 0; i < n; ++i) {
+    if (t.H_null[i] <= 0) continue;
+    const double ratio = t.H[i] / t.H_null[i];
+    r_min = qMin(r_min, ratio);
+    if (t.H[i] > 0) r_pos = qMin(r_pos, ratio);
+  }
+  for (int j = 0; j < m; ++j) {
+    if (e.min_H < 0)
+      r.type[j] = 3;
+    else if (s[j] <= r_min)
+      r.type[j] = 1;
+    else
+      r.type[j] = (e.min_H > 0 || s[j] > r_pos) ? 2 : 1;
+  }
+
+  const double L = l.params.area_length;
+  if (e.min_H < 0) {
+    r.wp = Diffraction::loss(t, l.tx, l.rx, lambda, l.diffraction);
+  } else {
+    // Полуоткрытый интервал: затеняющее препятствие от частоты не зависит
+    const int sh = std::min_element(t.H.begin(), t.H.end()) - t.H.begin();
+    const double v = Diffraction::shadingParam(
+        -t.H[sh], t.x[sh] - t.x.first(), t.ye[sh] - t.y.first(),
+        t.x[sh] - t.x.last(), t.ye[sh] - t.y.last(), 1.0);
+
+    // Открытый интервал: точки отражения от частоты не зависят
+    QVector<int> points;
+    Kernel::reflections(t, l.tx.y, l.rx.y, points);
+    const Kernel::RangeMin min_H(t.H);
+
+    for (int j = 0; j < m; ++j) {
+      if (r.type[j] == 2) {
+        r.wp[j] = Diffraction::atten(v / s[j]);
+        continue;
+      }
+      for (int k = 0; k < points.size(); ++k) {
+        const double w = Kernel::reflection(t, min_H, points[k], lambda[j],
+                                            l.reflection_coef, s[j])
+                             .wp;
+        if (!k || w > r.wp[j]) r.wp[j] = w;
+      }
+    }
+  }
+
+  const Atmosphere::Table &table = Atmosphere::Table::instance();
+  QVector<Atmosphere::Rain::Link> links(m);
+  for (int j = 0; j < m; ++j) {
+    r.ws[j] = Budget::freeSpace(L, lambda[j]);
+    r.wa[j] = (L / 1000) * table.gamma(f[j] / 1000, l.atmosphere).total();
+    links[j] = {f[j] / 1000, L / 1000, l.rain_rate, l.polarization};
+  }
+  Atmosphere::Rain::Batch(links).attenuation(QVector<double>(1, l.percent),
+                                             r.wr);
+
+  for (int j = 0; j < m; ++j) {
+    r.q[j] = l.gain - r.wp[j] - r.ws[j] - r.wa[j];
+    r.stock[j] = stock.value(j) + r.wr[j];
+  }
+  return r;
+}
+
+}  // namespace Band
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,73 @@
+#ifndef NRRLSBAND_H
+#define NRRLSBAND_H
+
+#include <QMap>
+
+#include "nrrlsatmosphere.h"
+#include "nrrlsdiffraction.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Band {
+
+/**
+ * Параметры интервала, не зависящие от частоты
+ */
+struct Link {
+  Kernel::Params params;  ///< Параметры трассы, длина волны не используется
+  Kernel::Track track;    ///< Профиль, массивы x и y должны быть заполнены
+  Diffraction::Point tx;  ///< Передающая антенна
+  Diffraction::Point rx;  ///< Приемная антенна
+  Diffraction::Options diffraction;
+  Atmosphere::Conditions atmosphere;
+  QMap<double, QVector<double>> reflection_coef;  ///< Коэффициенты отражения
+                                                  ///< по длинам волн
+  double gain = 0;  ///< Запас связи без учета затуханий на трассе (в дБ)
+  double rain_rate = 0;  ///< Интенсивность дождя, превышаемая 0,01% времени
+                         ///< (в мм/ч)
+  double polarization = 0;  ///< Угол наклона поляризации (в градусах)
+  double percent = 0;  ///< Процент времени для затухания в дожде
+};
+
+/**
+ * Результат расчета по частотам
+ */
+struct Result {
+  QVector<double> f;  ///< Частоты (в МГц)
+  QVector<int> type;  ///< Типы интервала: 1-Открытый, 2-Полуоткрытый,
+                      ///< 3-Закрытый
+  QVector<double> ws;  ///< Затухания в свободном пространстве
+  QVector<double> wa;  ///< Затухания в газах атмосферы
+  QVector<double> wp;  ///< Затухания в рельефе
+  QVector<double> wr;  ///< Затухания в дожде
+  QVector<double> q;   ///< Запасы связи
+  QVector<double> stock;  ///< Требуемые запасы связи с учетом дождя
+};
+
+/**
+ * Функция построения равномерной сетки частот
+ * @param begin   - начальная частота
+ * @param end     - конечная частота (включительно)
+ * @param step    - шаг
+ */
+QVector<double> grid(double begin, double end, double step);
+
+/**
+ * Функция расчета запаса связи и типа интервала в полосе частот. Профиль
+ * рассчитывается один раз: от частоты зависят только критические просветы,
+ * которые пропорциональны корню из длины волны, поэтому тип интервала для
+ * каждой частоты определяется сравнением с двумя свертками профиля.
+ * Затухания рассчитываются по массивам частот
+ * @param l       - параметры интервала
+ * @param f       - частоты (в МГц)
+ * @param stock   - требуемые запасы связи без учета дождя по частотам
+ * @return Затухания, запасы и типы интервала по частотам
+ */
+Result evaluate(const Link &l, const QVector<double> &f,
+                const QVector<double> &stock);
+
+}  // namespace Band
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSBAND_H
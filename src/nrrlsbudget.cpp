@@ -0,0 +1,278 @@
+#include "nrrlsbudget.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Budget {
+
+double gamma(const Atmosphere::Conditions &c, double f, double &df) {
+  // Таблица интерполируется кусочно-линейно, поэтому производная берется
+  // центральной разностью с шагом меньше шага таблицы
+  const Atmosphere::Table &t = Atmosphere::Table::instance();
+  const double h = f * 1e-4;
+  df = (t.gamma((f + h) / 1000, c).total() -
+        t.gamma((f - h) / 1000, c).total()) /
+       (2 * h);
+  return t.gamma(f / 1000, c).total();
+}
+
+IA::Interval air(const Atmosphere::Conditions &c, const IA::Interval &f,
+                 double l) {
+  const Atmosphere::Table &t = Atmosphere::Table::instance();
+  const Atmosphere::Table::Axis &axis = Atmosphere::Table::f_axis;
+  double lo = t.gamma(f.lo() / 1000, c).total(), hi = lo;
+  const double g = t.gamma(f.hi() / 1000, c).total();
+  lo = qMin(lo, g);
+  hi = qMax(hi, g);
+
+  // Узлы таблицы внутри интервала частот
+  const double a = log10(qMax(f.lo() / 1000, 1e-6));
+  const double b = log10(qMax(f.hi() / 1000, 1e-6));
+  const int first = qMax(0, qCeil((a - axis.min) / axis.step));
+  const int last = qMin(axis.n - 1, qFloor((b - axis.min) / axis.step));
+  for (int i = first; i <= last; ++i) {
+    const double v = t.gamma(qPow(10, axis.value(i)), c).total();
+    lo = qMin(lo, v);
+    hi = qMax(hi, v);
+  }
+  return IA::Interval(l / 1000 * lo, l / 1000 * hi);
+}
+
+namespace {
+
+typedef Detail::Geometry<IA::Interval> Geometry;
+typedef Detail::End<IA::Interval> End;
+
+/**
+ * Оболочка затухания полуоткрытого интервала по всем точкам, просвет
+ * которых может оказаться наименьшим
+ * @param min_H   - границы наименьшего просвета
+ * @param wp      - оболочка затухания
+ * @return Признак того, что концы интервала не могут оказаться затеняющим
+ * препятствием
+ */
+bool shading(const Geometry &g, int n, const IA::Interval &min_H,
+             IA::Interval &wp) {
+  double lo = HUGE_VAL, hi = -HUGE_VAL;
+  for (int i = 0; i < n; ++i) {
+    const IA::Interval H = g.los(g.x[i]) - g.ye(i);
+    if (H.lo() > min_H.hi()) continue;
+    if (i == 0 || i == n - 1) return false;
+    const IA::Interval w = Detail::shading(g, i, n);
+    lo = qMin(lo, w.lo());
+    hi = qMax(hi, w.hi());
+  }
+  wp = IA::Interval(lo, hi);
+  return true;
+}
+
+/**
+ * Наибольшее число участков, просматриваемых при построении оболочки
+ * Deygout
+ */
+const int deygout_budget = 4096;
+
+/**
+ * Оболочка затухания Deygout по всем препятствиям, которые могут оказаться
+ * главными. Главным на участке может стать любая точка, верхняя граница
+ * параметра дифракции которой не меньше наибольшей нижней границы. Для
+ * каждой такой точки затухание на ней складывается с оболочками левой и
+ * правой частей; если затухание на ней может быть нулевым, расчет на
+ * участке может остановиться, и оболочка включает 0
+ * @param budget  - оставшееся число участков, при исчерпании оболочка не
+ *                  строится
+ * @return Признак того, что оболочка построена
+ */
+bool deygout(const Geometry &g, const End &a, const End &b, int depth,
+             int &budget, IA::Interval &wp) {
+  wp = 0;
+  if (depth <= 0 || b.idx - a.idx < 2) return true;
+  if (--budget < 0) return false;
+
+  QVector<IA::Interval> v(b.idx - a.idx - 1);
+  double v_lo = -HUGE_VAL;
+  for (int i = a.idx + 1; i < b.idx; ++i) {
+    v[i - a.idx - 1] = Detail::edgeParam(g, i, a.x, a.y, b.x, b.y);
+    v_lo = qMax(v_lo, v[i - a.idx - 1].lo());
+  }
+
+  double lo = HUGE_VAL, hi = -HUGE_VAL;
+  for (int i = a.idx + 1; i < b.idx; ++i) {
+    const IA::Interval &v_i = v[i - a.idx - 1];
+    if (v_i.hi() < v_lo) continue;
+
+    IA::Interval w = Diffraction::atten(v_i);
+    if (w.hi() > 0) {
+      const End m = {i, g.x[i], g.ye(i)};
+      IA::Interval left, right;
+      if (!deygout(g, a, m, depth - 1, budget, left) ||
+          !deygout(g, m, b, depth - 1, budget, right))
+        return false;
+      w += left + right;
+    }
+    lo = qMin(lo, Diffraction::atten(v_i.lo()) > 0 ? w.lo() : 0.0);
+    hi = qMax(hi, w.hi());
+  }
+  wp = IA::Interval(lo, hi);
+  return true;
+}
+
+/**
+ * Подтверждение препятствий Epstein-Peterson: положение каждой точки
+ * относительно ЛПВ, вершины препятствий, их слияние, как в
+ * Kernel::obstacles, и выбор depth наивысших вершин не меняются при всех
+ * значениях параметров
+ */
+bool epsteinPeterson(const Geometry &g, int n, int depth,
+                     const QVector<Diffraction::Edge> &edges) {
+  // Сравнение высот вершин: 1 - первая выше, 0 - не выше, -1 - не
+  // определено
+  auto higher = [&](int i, int j) {
+    const IA::Interval a = g.ye(i), b = g.ye(j);
+    return a > b ? 1 : a <= b ? 0 : -1;
+  };
+
+  QVector<int> tops;
+  auto push = [&](int top) {
+    if (tops.isEmpty() ||
+        !Kernel::mergeable(g.l, g.x[tops.last()] - g.x0, g.x[top] - g.x0)) {
+      tops.push_back(top);
+      return true;
+    }
+    const int c = higher(top, tops.last());
+    if (c > 0) tops.last() = top;
+    return c >= 0;
+  };
+
+  int top = -1;
+  for (int i = 0; i < n; ++i) {
+    const IA::Interval d = g.ye(i) - g.los(g.x[i]);
+    if (!(d > 0) && !(d < 0)) return false;
+    if (top < 0 && d > 0) {
+      top = i;
+    } else if (top >= 0 && d < 0) {
+      if (!push(top)) return false;
+      top = -1;
+    } else if (top >= 0) {
+      const int c = higher(i, top);
+      if (c < 0) return false;
+      if (c > 0) top = i;
+    }
+  }
+  if (top >= 0 && !push(top)) return false;
+
+  // Выбранные вершины при всех значениях выше остальных над ЛПВ
+  if (depth > 0 && tops.size() > depth) {
+    QVector<int> chosen;
+    double chosen_hi = -HUGE_VAL, rest_lo = HUGE_VAL;
+    for (int i : tops) {
+      const IA::Interval H = g.los(g.x[i]) - g.ye(i);
+      const bool selected =
+          std::any_of(edges.begin(), edges.end(),
+                      [&](const Diffraction::Edge &e) { return e.idx == i; });
+      if (selected) {
+        chosen.push_back(i);
+        chosen_hi = qMax(chosen_hi, H.hi());
+      } else {
+        rest_lo = qMin(rest_lo, H.lo());
+      }
+    }
+    if (chosen_hi >= rest_lo) return false;
+    tops = chosen;
+  }
+
+  if (tops.size() != edges.size()) return false;
+  for (int k = 0; k < tops.size(); ++k)
+    if (tops[k] != edges[k].idx) return false;
+  return true;
+}
+
+}  // namespace
+
+Outputs<Dual> sensitivity(const Path &p, const Inputs<double> &in) {
+  Inputs<Dual> d;
+  d.h1 = Dual::variable(in.h1, Height1);
+  d.h2 = Dual::variable(in.h2, Height2);
+  d.f = Dual::variable(in.f, Freq);
+  d.g = Dual::variable(in.g, Gradient);
+  d.p1 = Dual::variable(in.p1, Power1);
+  d.p2 = Dual::variable(in.p2, Power2);
+  d.c1 = Dual::variable(in.c1, Gain1);
+  d.c2 = Dual::variable(in.c2, Gain2);
+  d.wf1 = Dual::variable(in.wf1, Feeder1);
+  d.wf2 = Dual::variable(in.wf2, Feeder2);
+  d.s = Dual::variable(in.s, Sensitivity);
+  return evaluate(p, d);
+}
+
+Outputs<IA::Interval> bounds(const Path &p, const Inputs<IA::Interval> &in,
+                             bool &stable) {
+  stable = false;
+  const int n = p.x.size();
+  if (n < 2) return Outputs<IA::Interval>();
+
+  // Наименьшие просвет и превышение просвета над критическим по всем
+  // точкам, как при определении типа интервала
+  const Geometry g(p, in);
+  IA::Interval min_H = HUGE_VAL, min_H_margin = HUGE_VAL;
+  for (int i = 0; i < n; ++i) {
+    const double k = g.k(i);
+    const IA::Interval H = g.los(g.x[i]) - g.ye(i);
+    const IA::Interval H_null =
+        i < n - 1 ? qSqrt(g.l * g.lambda * (k * (1 - k) / 3)) : 0;
+    min_H = qMin(min_H, H);
+    min_H_margin = qMin(min_H_margin, H - H_null);
+  }
+  switch (p.type) {
+    case 1:
+      stable = min_H_margin >= 0;
+      break;
+    case 2:
+      stable = min_H > 0 && min_H_margin < 0;
+      break;
+    case 3:
+      stable = min_H < 0;
+      break;
+  }
+
+  Outputs<IA::Interval> o = evaluate(p, in);
+  if (!stable) return o;
+
+  // Дискретные решения зависят только от геометрии трассы и частоты
+  if (in.h1.width() == 0 && in.h2.width() == 0 && in.f.width() == 0 &&
+      in.g.width() == 0)
+    return o;
+
+  switch (p.type) {
+    case 1:
+      stable = false;
+      break;
+    case 2:
+      stable = shading(g, n, min_H, o.wp);
+      Detail::levels(in, o);
+      break;
+    case 3: {
+      const End a = {0, g.x[0], g.a};
+      const End b = {n - 1, g.x[n - 1], g.los(g.x[n - 1])};
+      switch (p.diffraction.method) {
+        case Diffraction::Method::Deygout: {
+          int budget = deygout_budget;
+          stable = deygout(g, a, b, p.diffraction.depth, budget, o.wp);
+          if (!stable) o.wp = evaluate(p, in).wp;
+          Detail::levels(in, o);
+          break;
+        }
+        case Diffraction::Method::EpsteinPeterson:
+          stable = epsteinPeterson(g, n, p.diffraction.depth, p.edges);
+          break;
+        case Diffraction::Method::Bullington:
+          break;
+      }
+      break;
+    }
+  }
+  return o;
+}
+
+}  // namespace Budget
+}  // namespace Calc
+}  // namespace NRrls
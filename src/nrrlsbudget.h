@@ -0,0 +1,419 @@
+#ifndef NRRLSBUDGET_H
+#define NRRLSBUDGET_H
+
+#include "nrrlsatmosphere.h"
+#include "nrrlsdiffraction.h"
+#include "nrrlsdual.h"
+#include "nrrlsinterval.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Budget {
+
+/**
+ * Номера входных параметров энергетического расчета
+ */
+enum Param {
+  Height1,      ///< Высота подвеса первой антенны
+  Height2,      ///< Высота подвеса второй антенны
+  Freq,         ///< Частота
+  Gradient,     ///< Градиент индекса преломления
+  Power1,       ///< Мощность первого передатчика
+  Power2,       ///< Мощность второго передатчика
+  Gain1,        ///< КУ первой антенны
+  Gain2,        ///< КУ второй антенны
+  Feeder1,      ///< Потери в первом фидере
+  Feeder2,      ///< Потери во втором фидере
+  Sensitivity,  ///< Чувствительность приемника
+  Count         ///< Число параметров
+};
+
+/**
+ * Число, переносящее производные по всем входным параметрам
+ */
+typedef AD::Dual<Count> Dual;
+
+/**
+ * Непрерывные входные параметры расчета
+ */
+template <typename T>
+struct Inputs {
+  T h1, h2;    ///< Высоты подвеса антенн (в метрах)
+  T f;         ///< Частота (в МГц)
+  T g;         ///< Градиент индекса преломления (в 1/м)
+  T p1, p2;    ///< Мощности передатчиков (в Вт)
+  T c1, c2;    ///< КУ антенн (в дБ)
+  T wf1, wf2;  ///< Потери в фидерах (в дБ)
+  T s;         ///< Чувствительность приемника (в дБ)
+};
+
+/**
+ * Дискретные решения, принятые при последнем расчете. При малых изменениях
+ * параметров они не меняются, поэтому производные берутся при их
+ * фиксированных значениях
+ */
+struct Path {
+  QVector<double> x;  ///< Расстояния
+  QVector<double> y;  ///< Высоты рельефа
+  double radius = 0;  ///< Радиус Земли
+  Atmosphere::Conditions atmosphere;
+  int type = 0;  ///< Тип интервала: 1-Открытый, 2-Полуоткрытый, 3-Закрытый
+  int reflection = -1;  ///< Индекс точки отражения с наибольшим затуханием,
+                        ///< -1 - точек отражения нет
+  int sphere = -1;  ///< Индекс минимального просвета на участке отражения при
+                    ///< аппроксимации сферой, -1 - аппроксимация плоскостью
+  double phi_null = 1;  ///< Коэффициент отражения
+  int shading = 0;      ///< Индекс затеняющего препятствия
+  Diffraction::Options diffraction;
+  QVector<Diffraction::Edge> edges;  ///< Препятствия закрытого интервала
+};
+
+/**
+ * Результат энергетического расчета
+ */
+template <typename T>
+struct Outputs {
+  T ws;  ///< Затухание в свободном пространстве
+  T wa;  ///< Затухание в газах атмосферы
+  T wp;  ///< Затухание в рельефе
+  T p1;  ///< Медианный уровень сигнала на входе первого приемника
+  T p2;  ///< Медианный уровень сигнала на входе второго приемника
+  T q;   ///< Запас связи
+};
+
+/**
+ * Функция расчета затухания в свободном пространстве
+ * @param l       - длина интервала (в метрах)
+ * @param lambda  - длина волны (в метрах)
+ */
+template <typename T>
+T freeSpace(double l, const T &lambda) {
+  return 122 + 20 * log10((l / 1e+3) / (lambda * 1e+2));
+}
+
+/**
+ * Функция расчета медианного уровня сигнала на входе приемника (в дБВт)
+ * @param p       - мощность передатчика (в Вт)
+ * @param wf_t    - потери в фидере передатчика
+ * @param c_t     - КУ антенны передатчика
+ * @param w       - суммарное затухание на интервале
+ * @param c_r     - КУ антенны приемника
+ * @param wf_r    - потери в фидере приемника
+ */
+template <typename T>
+T level(const T &p, const T &wf_t, const T &c_t, const T &w, const T &c_r,
+        const T &wf_r) {
+  return 10 * log10(p) - wf_t + c_t - w + c_r - wf_r;
+}
+
+/**
+ * Функция перевода чувствительности приемника в дБВт:
+ * 10 * log10((10^(s/20) * 1e-6)^2 / 50)
+ * @param s       - чувствительность (в дБмкВ)
+ */
+template <typename T>
+T toDbvt(const T &s) {
+  return s - 120 - 10 * log10(50.0);
+}
+
+/**
+ * Функция расчета погонного затухания в газах и его производной по частоте
+ * @param c       - состояние атмосферы
+ * @param f       - частота (в МГц)
+ * @param df      - производная (в дБ/км/МГц)
+ * @return Погонное затухание (в дБ/км)
+ */
+double gamma(const Atmosphere::Conditions &c, double f, double &df);
+
+/**
+ * Функция расчета затухания в газах атмосферы
+ * @param c       - состояние атмосферы
+ * @param f       - частота (в МГц)
+ * @param l       - длина интервала (в метрах)
+ */
+template <typename T>
+T air(const Atmosphere::Conditions &c, const T &f, double l) {
+  double df = 0;
+  const double g = gamma(c, AD::value(f), df);
+  return AD::chain(f, l / 1000 * g, l / 1000 * df);
+}
+
+/**
+ * Границы затухания в газах атмосферы в интервале частот. Таблица
+ * интерполируется линейно по логарифму частоты, поэтому экстремумы
+ * достигаются на концах интервала или в узлах таблицы
+ */
+IA::Interval air(const Atmosphere::Conditions &c, const IA::Interval &f,
+                 double l);
+
+}  // namespace Budget
+
+namespace Diffraction {
+
+/**
+ * Затухание на клиновидном препятствии не убывает с ростом параметра
+ * дифракции, поэтому границы интервала переходят в границы затухания
+ */
+template <>
+inline IA::Interval atten(const IA::Interval &v) {
+  return IA::Interval(atten(v.lo()), atten(v.hi()));
+}
+
+}  // namespace Diffraction
+
+namespace Budget {
+
+namespace Detail {
+
+/**
+ * Геометрия интервала при заданных высотах антенн и градиенте
+ */
+template <typename T>
+class Geometry {
+ public:
+  Geometry(const Path &p, const Inputs<T> &in)
+      : x(p.x.constData()),
+        y(p.y.constData()),
+        x0(p.x.first()),
+        l(p.x.last() - p.x.first()),
+        lambda(3e+8 / (in.f * 1e+6)),
+        inv_2r((1 + in.g * p.radius / 2) / (2 * p.radius)),
+        a(p.y.first() + in.h1),
+        s((p.y.last() + in.h2 - a) / l) {}
+
+  /**
+   * Высота профиля с учетом земной поверхности
+   */
+  T ye(int i) const {
+    const double m = x[i] - x0 - l / 2;
+    return y[i] + (l * l / 4 - m * m) * inv_2r;
+  }
+
+  /**
+   * Высота ЛПВ
+   */
+  T los(double xi) const { return a + s * (xi - x0); }
+
+  /**
+   * Относительная координата точки
+   */
+  double k(int i) const { return (x[i] - x0) / l; }
+
+  const double *x, *y;
+  double x0;
+  double l;  ///< Длина интервала
+  T lambda;
+  T inv_2r;  ///< 1 / (2 * эквивалентный радиус)
+  T a;       ///< Высота первой антенны над уровнем моря
+  T s;       ///< Наклон ЛПВ
+};
+
+/**
+ * Конец участка при повторении расчета по Deygout
+ */
+template <typename T>
+struct End {
+  int idx;
+  double x;
+  T y;
+};
+
+/**
+ * Параметр дифракции точки i относительно прямой, соединяющей концы
+ */
+template <typename T>
+T edgeParam(const Geometry<T> &g, int i, double lx, const T &ly, double rx,
+            const T &ry) {
+  const T h = g.ye(i) - (ly + (ry - ly) * ((g.x[i] - lx) / (rx - lx)));
+  return Diffraction::param<T>(h, g.x[i] - lx, rx - g.x[i], g.lambda);
+}
+
+/**
+ * Повторение расчета по Deygout с препятствиями последнего расчета.
+ * Препятствия записаны в прямом порядке обхода, поэтому очередное
+ * препятствие принадлежит участку, если лежит внутри него
+ */
+template <typename T>
+T deygout(const Geometry<T> &g, const QVector<Diffraction::Edge> &edges,
+          const End<T> &a, const End<T> &b, int depth, int &next) {
+  if (depth <= 0 || next >= edges.size()) return 0;
+  const int m = edges[next].idx;
+  if (m <= a.idx || m >= b.idx) return 0;
+  ++next;
+
+  const End<T> e = {m, g.x[m], g.ye(m)};
+  // Порядок обхода задан явно: левая часть должна разобрать свои препятствия
+  // раньше правой
+  T w = Diffraction::atten(edgeParam(g, m, a.x, a.y, b.x, b.y));
+  w += deygout(g, edges, a, e, depth - 1, next);
+  w += deygout(g, edges, e, b, depth - 1, next);
+  return w;
+}
+
+template <typename T>
+T epsteinPeterson(const Geometry<T> &g,
+                  const QVector<Diffraction::Edge> &edges, const End<T> &a,
+                  const End<T> &b) {
+  T w = 0;
+  for (int k = 0; k < edges.size(); ++k) {
+    const int i = edges[k].idx;
+    const End<T> l =
+        k ? End<T>{edges[k - 1].idx, g.x[edges[k - 1].idx],
+                   g.ye(edges[k - 1].idx)}
+          : a;
+    const End<T> r =
+        k + 1 < edges.size()
+            ? End<T>{edges[k + 1].idx, g.x[edges[k + 1].idx],
+                     g.ye(edges[k + 1].idx)}
+            : b;
+    w += Diffraction::atten(edgeParam(g, i, l.x, l.y, r.x, r.y));
+  }
+  return w;
+}
+
+template <typename T>
+T bullington(const Geometry<T> &g, int n, const End<T> &a, const End<T> &b) {
+  if (n < 3) return 0;
+
+  // Наибольшие наклоны прямых, проведенных от концов к профилю
+  T s_a = -HUGE_VAL, s_b = -HUGE_VAL;
+  for (int i = 1; i < n - 1; ++i) {
+    const T sa = (g.ye(i) - a.y) / (g.x[i] - a.x);
+    const T sb = (g.ye(i) - b.y) / (b.x - g.x[i]);
+    s_a = qMax(s_a, sa);
+    s_b = qMax(s_b, sb);
+  }
+  if (s_a + s_b <= 0) return 0;
+
+  return Diffraction::atten(Diffraction::bullingtonParam<T>(
+      s_a, s_b, {a.x, 0}, a.y, {b.x, 0}, b.y, g.lambda));
+}
+
+/**
+ * Затухание на затеняющем препятствии i полуоткрытого интервала
+ */
+template <typename T>
+T shading(const Geometry<T> &g, int i, int n) {
+  return Diffraction::atten(Diffraction::shadingParam<T>(
+      g.ye(i) - g.los(g.x[i]), g.x[i] - g.x[0], g.ye(i) - g.y[0],
+      g.x[i] - g.x[n - 1], g.ye(i) - g.y[n - 1], g.lambda));
+}
+
+/**
+ * Затухание в рельефе
+ */
+template <typename T>
+T relief(const Path &p, const Geometry<T> &g) {
+  const int n = p.x.size();
+  switch (p.type) {
+    case 1: {
+      if (p.reflection < 0) return 0;
+      const int i = p.reflection;
+      const double k = g.k(i);
+      const T H = g.los(g.x[i]) - g.ye(i);
+      T delta_r = H * H / (2 * g.l * k * (1 - k));
+      if (p.sphere >= 0) {
+        const int j = p.sphere;
+        const double kj = g.k(j);
+        delta_r = (g.los(g.x[j]) - g.ye(j)) /
+                  qSqrt(g.l * g.lambda * (kj * (1 - kj) / 3));
+      }
+      // Квадрат относительного просвета в точке отражения
+      return Kernel::interference<T>(p.phi_null, 6 * delta_r * g.lambda);
+    }
+    case 2:
+      return shading(g, p.shading, n);
+    case 3: {
+      const End<T> a = {0, g.x[0], g.a};
+      const End<T> b = {n - 1, g.x[n - 1], g.los(g.x[n - 1])};
+      switch (p.diffraction.method) {
+        case Diffraction::Method::Deygout: {
+          int next = 0;
+          return deygout(g, p.edges, a, b, p.diffraction.depth, next);
+        }
+        case Diffraction::Method::EpsteinPeterson:
+          return epsteinPeterson(g, p.edges, a, b);
+        case Diffraction::Method::Bullington:
+          return bullington(g, n, a, b);
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Уровни сигнала и запас связи по рассчитанным затуханиям
+ */
+template <typename T>
+void levels(const Inputs<T> &in, Outputs<T> &o) {
+  const T w = o.wp + o.ws + o.wa;
+  o.p1 = level(in.p1, in.wf1, in.c1, w, in.c2, in.wf2);
+  o.p2 = level(in.p2, in.wf2, in.c2, w, in.c1, in.wf1);
+  o.q = qMin(o.p1, o.p2) - toDbvt(in.s);
+}
+
+}  // namespace Detail
+
+/**
+ * Функция энергетического расчета интервала. Расчет записан для
+ * произвольного числового типа: для double дает значения, для Dual -
+ * значения вместе с производными по всем параметрам за один проход. Формулы
+ * общие с составляющими головного расчета, поэтому для double при решениях
+ * последнего расчета результат совпадает с ним
+ * @param p       - профиль и дискретные решения последнего расчета
+ * @param in      - входные параметры
+ * @return Затухания, уровни сигнала и запас связи
+ */
+template <typename T>
+Outputs<T> evaluate(const Path &p, const Inputs<T> &in) {
+  Outputs<T> o;
+  if (p.x.size() < 2) return o;
+
+  const Detail::Geometry<T> g(p, in);
+  o.ws = freeSpace(g.l, g.lambda);
+
+  o.wa = air(p.atmosphere, in.f, g.l);
+
+  o.wp = Detail::relief(p, g);
+
+  Detail::levels(in, o);
+  return o;
+}
+
+/**
+ * Функция расчета чувствительности запаса связи: затухания, уровни и запас
+ * вместе с производными по всем параметрам за один проход
+ * @param p       - профиль и дискретные решения последнего расчета
+ * @param in      - входные параметры
+ * @return Результат с производными, номера производных - Param
+ */
+Outputs<Dual> sensitivity(const Path &p, const Inputs<double> &in);
+
+/**
+ * Функция расчета границ затуханий, уровней и запаса связи при входных
+ * параметрах, заданных интервалами, за один проход. Границы гарантированы,
+ * только если подтверждены тип интервала и дискретные решения последнего
+ * расчета. На полуоткрытом интервале берется оболочка затухания по всем
+ * точкам, которые могут оказаться затеняющим препятствием. На закрытом
+ * интервале решение Bullington не содержит выбора, для Deygout берется
+ * оболочка по всем препятствиям, которые могут оказаться главными на
+ * каждом участке, а препятствия Epstein-Peterson подтверждаются: положение
+ * точек относительно ЛПВ, вершины и выбор наивысших из них не меняются. Точка
+ * отражения и коэффициент отражения открытого интервала не подтверждаются,
+ * поэтому его границы гарантированы, только если высоты антенн, частота и
+ * градиент заданы точно
+ * @param p       - профиль и дискретные решения последнего расчета
+ * @param in      - входные параметры
+ * @param stable  - признак того, что тип интервала и дискретные решения
+ *                  подтверждены при всех значениях параметров и границы
+ *                  гарантированы
+ * @return Границы результата
+ */
+Outputs<IA::Interval> bounds(const Path &p, const Inputs<IA::Interval> &in,
+                             bool &stable);
+
+}  // namespace Budget
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSBUDGET_H
@@ -13,15 +13,12 @@ namespace Fill {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(Calc::Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Calc::Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
+  static constexpr int inputs() { return Input::File; }
   void paramFill(void);
-
- private:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
 };
 
 }  // namespace Fill
@@ -33,14 +30,15 @@ namespace Profile {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Calc::Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Calc::Data &data) : Calc::Item(data) {}
 
  public:
-  virtual bool exec() override;
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Gradient | Input::Heights | Input::Freq;
+  }
 
  protected:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
   QCustomPlot *cp = data->mainWindow->customplot;
   decltype(data->param.coords) coords = data->param.coords;
 };
@@ -50,11 +48,10 @@ class Item : public Calc::Item {
  */
 class Axes : public Profile::Item {
  public:
-  QSHDEF(Axes);
-  Axes(const Calc::Data::WeakPtr &data) : Profile::Item(data) {}
+  explicit Axes(Calc::Data &data) : Profile::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 };
 
 /**
@@ -62,11 +59,10 @@ class Axes : public Profile::Item {
  */
 class Earth : public Profile::Item {
  public:
-  QSHDEF(Earth);
-  Earth(const Calc::Data::WeakPtr &data) : Profile::Item(data) {}
+  explicit Earth(Calc::Data &data) : Profile::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 
  private:
   void drawHeightProfile(const QVector<double> &x, const QVector<double> &y);
@@ -84,11 +80,10 @@ class Earth : public Profile::Item {
  */
 class Fresnel : public Profile::Item {
  public:
-  QSHDEF(Fresnel);
-  Fresnel(const Calc::Data::WeakPtr &data) : Profile::Item(data) {}
+  explicit Fresnel(Calc::Data &data) : Profile::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 };
 
 /**
@@ -96,11 +91,10 @@ class Fresnel : public Profile::Item {
  */
 class Los : public Profile::Item {
  public:
-  QSHDEF(Los);
-  Los(const Calc::Data::WeakPtr &data) : Profile::Item(data) {}
+  explicit Los(Calc::Data &data) : Profile::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 };
 
 }  // namespace Profile
@@ -112,14 +106,13 @@ namespace Interval {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
-
- protected:
-  QSharedPointer<NRrls::Calc::Data> data = _data.toStrongRef();
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Gradient | Input::Heights | Input::Freq;
+  }
 
  private:
   void colourArea(int r, int g, int b, int a);
@@ -136,24 +129,15 @@ namespace Land {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  virtual bool exec() override;
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Gradient | Input::Heights | Input::Freq;
+  }
 
  protected:
-  /**
-   * Функция проверки касательности прямой к высотному профилю
-   * @param a         - y = a * x + b
-   * @param b         - y = a * x + b
-   * @param start     - начальный индекс рассматриваемого интервала
-   * @param end       - конечный индекс рассматриваемого интервала
-   * @return Будет ли прямая касательной
-   */
-  bool _isTangent(double a, double b, double start, double end) const;
-
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
   decltype(data->param.coords) coords = data->param.coords;
 };
 
@@ -162,45 +146,10 @@ class Item : public Calc::Item {
  */
 class Opened : public Land::Item {
  public:
-  QSHDEF(Opened);
-  using iter = QMap<double, double>::const_iterator;
-  Opened(const Data::WeakPtr &data) : Land::Item(data) {}
+  explicit Opened(Data &data) : Land::Item(data) {}
 
  public:
-  bool exec() override;
-
- private:
-  /**
-   * Функция нахождения наивысшей точки пересечения высотного профиля и
-   * отрезка, соединяющего приемник и точку, зеркальную передатчику
-   * относительно высотного профиля
-   * @return Координаты наивысшей точки пересечения
-   */
-  QPair<int, int> _findPointOfIntersection(void);
-
-  /**
-   * Функция аппроксимации плоскостью
-   * @param start     - Индекс начальной точки участка отражения
-   * @param end       - Индекс конечной точки участка отражения
-   */
-  double _planeApproximation(QPair<int, int> intersec);
-
-  /**
-   * Функция аппроксимации сферой
-   * @param begin     - Индекс начальной точки участка отражения
-   * @param end       - Индекс конечной точки участка отражения
-   */
-  double _sphereApproximation(iter begin, iter end);
-
-  double _relief(iter begin, iter end);
-
- private:
-  /**
-   * Функция расчета затухания на открытом интервале
-   * @param phi_null  - коэффициент отражения
-   * @param p         - относительный просвет в точке отражения
-   */
-  inline double _atten(double phi_null, double p);
+  bool exec();
 };
 
 /**
@@ -208,30 +157,10 @@ class Opened : public Land::Item {
  */
 class SemiOpened : public Land::Item {
  public:
-  QSHDEF(SemiOpened);
-  SemiOpened(const Data::WeakPtr &data) : Land::Item(data) {}
+  explicit SemiOpened(Data &data) : Land::Item(data) {}
 
  public:
-  bool exec() override;
-
- private:
-  /**
-   * Функция нахождения затеняющего препятствия
-   * @return Пара .first  - индекс препятствия
-   *              .second - величина минимального
-   * просвета
-   */
-  QPair<double, double> _shadingObstacle(void) const;
-
-  double _tangent(const QPair<double, double> &p);
-
- private:
-  inline QPair<double, double> _pointOfIntersection(
-      QPair<double, double> l, QPair<double, double> r) const;
-
-  inline double _diffractionParam(double h, double d1, double d2) const;
-
-  inline double _atten(double param) const;
+  bool exec();
 };
 
 /**
@@ -239,60 +168,10 @@ class SemiOpened : public Land::Item {
  */
 class Closed : public Land::Item {
  public:
-  QSHDEF(Closed);
-  using Peaks = QList<QPair<double, double>>;
-
-  Closed(const Data::WeakPtr &data) : Land::Item(data) {}
+  explicit Closed(Data &data) : Land::Item(data) {}
 
  public:
-  bool exec() override;
-
- private:
-  /**
-   * Функция подсчета препятствий
-   * @return Отрезки, содержащие препятствия
-   */
-  auto _countPeaks(void) -> Peaks;
-
-  /**
-   * Функция аппроксимации одним эквивалентом
-   * @param v       - индексы затеняющих препятствий
-   */
-  void _approx(Peaks &v);
-
-  /**
-   * Функция нахождения прямых, касательных высотному профилю на отрезке [start,
-   * end]
-   * @param start   - индекс начальной точки
-   * @param end     - индекс конечной точки
-   */
-  double _reliefTangentStraightLines(const Peaks &p);
-
-  /**
-   * Функция построения уравнений прямых и проверки касательности их к высотному
-   * профилю
-   * @param start   - индекс входа ЛПВ в препятствие
-   * @param end     - индекс выхода ЛПВ из препятствия
-   * @param type    - передатчик/приемник
-   */
-  double _tangent(const QPair<double, double> &p,
-                  const QPair<double, double> &left,
-                  const QPair<double, double> &right);
-
-  /**
-   * @brief findlNull
-   * @param p
-   * @return
-   */
-  double _findlNull(std::pair<int, double> p);
-
- private:
-  inline QPair<double, double> _pointOfIntersection(
-      const QPair<double, double> &l, const QPair<double, double> &r);
-
-  inline double _diffractionParam(double h, double d1, double d2);
-
-  inline double _atten(double param);
+  bool exec();
 };
 
 }  // namespace Land
@@ -304,14 +183,11 @@ namespace Free {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
-
- private:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
+  bool exec();
+  static constexpr int inputs() { return Input::File | Input::Freq; }
 };
 
 }  // namespace Free
@@ -323,36 +199,50 @@ namespace Air {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
-
- private:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Freq | Input::Temperature | Input::Pressure |
+           Input::Humidity;
+  }
 };
 
 }  // namespace Air
 
-namespace Acceptable {
+namespace Rain {
 
 /**
- * Составляющая расчета. Расчет допустимой велиины затухания на рельефе
+ * Составляющая расчета. Расчет затухания в дожде
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Freq | Input::Prob | Input::Rain;
+  }
+};
 
- private:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
+}  // namespace Rain
 
- private:
-  double getStock(double t);
+namespace Acceptable {
+
+/**
+ * Составляющая расчета. Расчет допустимой велиины затухания на рельефе
+ */
+class Item : public Calc::Item {
+ public:
+  explicit Item(Data &data) : Calc::Item(data) {}
+
+ public:
+  bool exec();
+  static constexpr int inputs() {
+    return Input::Freq | Input::Sensitivity | Input::Prob;
+  }
 };
 
 }  // namespace Acceptable
@@ -366,32 +256,29 @@ namespace Sesr {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  virtual bool exec() override;
-
- protected:
-  QSharedPointer<Calc::Data> data = _data.toStrongRef();
+  bool exec();
+  static constexpr int inputs() {
+    return Input::File | Input::Heights | Input::Freq | Input::Rain;
+  }
 };
 
 class Sesrg : public Item {
  public:
-  QSHDEF(Sesrg);
-  Sesrg(const Data::WeakPtr &data) : Item(data) {}
+  explicit Sesrg(Data &data) : Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 };
 
 class Sesrc : public Item {
  public:
-  QSHDEF(Sesrc);
-  Sesrc(const Data::WeakPtr &data) : Item(data) {}
+  explicit Sesrc(Data &data) : Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
 };
 
 }  // namespace Sesr
@@ -415,26 +302,22 @@ namespace Median {
  */
 class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  bool exec() override;
+  bool exec();
+  static constexpr int inputs() {
+    return Input::Power | Input::Gain | Input::Feeder;
+  }
 };
 
 }  // namespace Median
 
 double Item::k(double R) const {
-  return R / (_data.toStrongRef()->constant.area_length);
-}
-
-double Item::lNull(double h0, double k) const {
-  return ((_data.toStrongRef()->constant.area_length) * qSqrt(1 + h0 * h0)) /
-         (1 + (h0 * h0) / (4 * k * (1 - k)));
+  return R / (data->constant.area_length);
 }
 
 double Item::HNull(double i) const {
-  auto data = _data.toStrongRef();
   return sqrt(data->constant.area_length * data->constant.lambda * k(i) *
               ((1 - k(i)) / 3));
 }
@@ -452,47 +335,52 @@ QPair<double, double> Calc::Item::strLineEquation(double x, double y, double xx,
 
 namespace Main {
 
-Item::Item(const Data::WeakPtr &data) : Master::Item(data) {
-  _items = {Fill::Item::Ptr::create(_data),
-            Profile::Item::Ptr::create(_data),
-            Interval::Item::Ptr::create(_data),
-            Atten::Land::Item::Ptr::create(_data),
-            Atten::Free::Item::Ptr::create(_data),
-            Atten::Air::Item::Ptr::create(_data),
-            Median::Item::Ptr::create(_data),
-            Atten::Acceptable::Item::Ptr::create(_data)};
-}
+/**
+ * Цепочка составляющих головного расчета
+ */
+typedef Pipeline<Fill::Item, Profile::Item, Interval::Item,
+                 Atten::Land::Item, Atten::Free::Item, Atten::Air::Item,
+                 Atten::Rain::Item, Median::Item, Atten::Acceptable::Item,
+                 Sesr::Item>
+    Chain;
 
 bool Item::exec() {
-  auto data_m = _data.toStrongRef()->mainWindow;
-  data_m->customplot->clearGraphs();
-  _data.toStrongRef()->gr =
-      QSharedPointer<GraphPainter>::create(data_m->customplot);
-  for (auto &item : _items) {
-    if (!item->exec()) return false;
-  }
-  data_m->customplot->replot();
+  auto data_m = data->mainWindow;
+  bool replot = false;
+
+  // Составляющие выполняются по цепочке, поэтому после первой перезапущенной
+  // перезапускаются и все последующие
+  const bool done = Chain::update(*data, data->changed, [&](int inputs) {
+    // Составляющие, зависящие от геометрии трассы, строят графики заново
+    if (!replot && inputs & Input::Heights) {
+      replot = true;
+      data_m->customplot->clearGraphs();
+      data->gr = QSharedPointer<GraphPainter>::create(data_m->customplot);
+    }
+  });
+  if (!done) return false;
+  data->changed = Input::None;
+
+  if (replot) data_m->customplot->replot();
   return true;
 }
 
 }  // namespace Main
 
 bool Profile::Item::exec() {
-  return (
-      Axes::Ptr::create(_data)->exec() && Earth::Ptr::create(_data)->exec() &&
-      Fresnel::Ptr::create(_data)->exec() && Los::Ptr::create(_data)->exec());
+  return Pipeline<Axes, Earth, Fresnel, Los>::exec(*data);
 }
 
 bool Atten::Land::Item::exec() {
   switch (data->interval_type) {
     case 1:  // Открытый
-      Opened::Ptr::create(_data)->exec();
+      Opened(*data).exec();
       break;
     case 2:  // Полуоткрытый
-      SemiOpened::Ptr::create(_data)->exec();
+      SemiOpened(*data).exec();
       break;
     case 3:  // Закрытый
-      Closed::Ptr::create(_data)->exec();
+      Closed(*data).exec();
       break;
     default:
       return false;
@@ -500,16 +388,6 @@ bool Atten::Land::Item::exec() {
   return true;
 }
 
-bool Atten::Land::Item::_isTangent(double a, double b, double start,
-                                   double end) const {
-  for (auto it = data->param.coordsAndEarth.lowerBound(start);
-       it != data->param.coordsAndEarth.lowerBound(end);
-       it += (end - start >= 0) ? 1 : -1) {
-    if (a * it.key() + b < it.value()) return false;
-  }
-  return true;
-}
-
 namespace Fill {
 
 bool Item::exec() {
@@ -556,9 +434,13 @@ bool Item::exec() {
     estream << QString("File %1 is empty\n").arg(data->filename);
     return false;
   }
+  data->param.track.x.clear();
+  data->param.track.y.clear();
+  coords.x(data->param.track.x);
+  coords.y(data->param.track.y);
+  data->pyramid = Coarse::Pyramid();
   paramFill();
 
-  if (_data.isNull()) return false;
   return true;
 }
 
@@ -567,9 +449,6 @@ void Item::paramFill(void) {
   data->tower.f.setX(coords.startX());
   data->tower.s.setX(coords.endX());
   data->constant.area_length = coords.endX() - coords.startX();
-  data->param.los =
-      strLineEquation(data->tower.f.x(), data->tower.f.y() + coords.startY(),
-                      data->tower.s.x(), data->tower.s.y() + coords.endY());
 }
 
 }  // namespace Fill
@@ -611,60 +490,41 @@ bool Axes::exec() {
   cp->xAxis2->setTickLabels(0);
   cp->xAxis2->setRange(0, data->constant.area_length);
 
-  if (_data.isNull()) return false;
   return true;
 }
 
 bool Earth::exec() {
-  QVector<double> x, y;
-  x.reserve(data->param.count);
-  y.reserve(data->param.count);
+  auto &track = data->param.track;
 
-  bool first = true;
-  double move_graph_up_value;
-  double half = data->constant.area_length / 2;
-  double equivalent_radius =
-      data->constant.radius /
-      (1 + data->constant.g_standard * data->constant.radius / 2);
-
-  coords.x(x);
-  auto it = x.begin();
+  data->param.los =
+      strLineEquation(data->tower.f.x(), data->tower.f.y() + coords.startY(),
+                      data->tower.s.x(), data->tower.s.y() + coords.endY());
 
-  for (double i = -half; it != x.end(); it = std::next(it), i = -half + *it) {
-    if (first) {
-      first = false;
-      move_graph_up_value = i * i / (2 * equivalent_radius);
-      y.push_back(0);
-    } else {
-      y.push_back(-(i * i / (2 * equivalent_radius)) + move_graph_up_value);
-    }
-  }
+  // Земная поверхность, ЛПВ, просветы, зона Френеля, тип интервала и
+  // просветы относительно зон рассчитываются за один проход по профилю
+  Kernel::Params p;
+  p.area_length = data->constant.area_length;
+  p.lambda = data->constant.lambda;
+  p.equivalent_radius = Kernel::equivalentRadius(data->constant.radius,
+                                                 data->constant.g_standard);
+  p.los = data->param.los;
+  data->param.extrema =
+      Kernel::profilePass(p, track, data->zones, data->clearance);
 
   QPen pen(QColor("#014506"), 2);
-  data->gr->draw(x, y, QObject::tr("Уровень моря"), pen,
+  data->gr->draw(track.x, track.earth, QObject::tr("Уровень моря"), pen,
                  QColor(12, 80, 255, 70));
 
-  drawHeightProfile(x, y);
-
-  x.clear(), y.clear();
+  drawHeightProfile(track.x, track.earth);
 
   paramFill();
 
-  if (!_data) return false;
   return true;
 }
 
 void Earth::drawHeightProfile(const QVector<double> &x,
                               const QVector<double> &y) {
-  auto jt = data->param.coordsAndEarth.begin();
-  for (int i = 0; jt != data->param.coordsAndEarth.end() && i < y.size();
-       ++i, ++jt)
-    jt.value() += y[i];
-
-  QVector<double> h;
-  h.reserve(data->param.count);
-  foreach (auto i, data->param.coordsAndEarth.values())
-    h.push_back(i);
+  const auto &h = data->param.track.ye;
 
   data->gr->draw(x, h, QObject::tr("Высотный профиль"),
                  QPen(QColor("#137ea8"), 2), QColor(130, 70, 14, 70));
@@ -704,79 +564,54 @@ void Earth::drawGrid(const QVector<double> &x, const QVector<double> &y,
 }
 
 void Earth::paramFill() {
-  LOOP_START(data->param.coordsAndEarth.begin(),
-             data->param.coordsAndEarth.end(), it);
-  data->param.H[it.key()] =
-      data->param.los.first * it.key() + data->param.los.second - it.value();
-  data->param.H_null[it.key()] = HNull(it.key());
-  data->param.h_null[it.key()] =
-      (data->param.H[it.key()] / data->param.H_null[it.key()]);
-  LOOP_END;
-  data->param.H_null[data->param.count - 1] = 0;
+  const auto &track = data->param.track;
+  auto &param = data->param;
+
+  // Словари по расстоянию нужны интерфейсу и расчету затуханий, массивы
+  // профиля упорядочены, поэтому вставка идет в конец без поиска
+  param.coordsAndEarth.clear();
+  param.H.clear();
+  param.H_null.clear();
+  param.h_null.clear();
+  for (int i = 0; i < track.size(); ++i) {
+    param.coordsAndEarth.insert(param.coordsAndEarth.cend(), track.x[i],
+                                track.ye[i]);
+    param.H.insert(param.H.cend(), track.x[i], track.H[i]);
+    param.H_null.insert(param.H_null.cend(), track.x[i], track.H_null[i]);
+    param.h_null.insert(param.h_null.cend(), track.x[i], track.h_null[i]);
+  }
 }
 
 bool Fresnel::exec() {
-  QVector<double> x, y;
-  x.reserve(data->param.count);
-  y.reserve(data->param.count);
-
-  coords.x(x);
-  LOOP_START(data->param.coordsAndEarth.begin(),
-             data->param.coordsAndEarth.end(), i);
-  y.push_back((-data->param.H_null[i.key()]) + data->param.los.first * i.key() +
-              data->param.los.second);
-  LOOP_END;
+  const auto &track = data->param.track;
 
   QPen pen(Qt::red, 2);
   data->fr_up_idx = data->gr->getNumber();
-  data->gr->draw(x, y, QObject::tr("Зона Френеля, верхняя дуга"), pen);
-
-  auto it = x.begin();
-  LOOP_START(y.begin(), y.end(), i);
-  *i += 2 * data->param.H_null[*it];
-  it = (it != x.end()) ? std::next(it) : std::prev(x.end());
-  LOOP_END;
+  data->gr->draw(track.x, track.fr_up,
+                 QObject::tr("Зона Френеля, верхняя дуга"), pen);
 
   data->fr_dw_idx = data->gr->getNumber();
-  data->gr->draw(x, y, QObject::tr("Зона Френеля, нижняя дуга"), pen);
-  x.clear(), y.clear();
+  data->gr->draw(track.x, track.fr_dw,
+                 QObject::tr("Зона Френеля, нижняя дуга"), pen);
 
-  if (!_data) return false;
   return true;
 }
 
 bool Los::exec() {
-  QVector<double> x, y;
-  x.reserve(data->param.count);
-  y.reserve(data->param.count);
-
-  coords.x(x);
-  for (auto it : qAsConst(x))
-    y.push_back(data->param.los.first * it + data->param.los.second);
-
   QPen pen(QColor("#d6ba06"), 2);
-  data->gr->draw(x, y, QObject::tr("Линия прямой видимости"), pen);
+  data->gr->draw(data->param.track.x, data->param.track.los,
+                 QObject::tr("Линия прямой видимости"), pen);
 
-  x.clear(), y.clear();
-
-  if (!_data) return false;
   return true;
 }
 
 }  // namespace Profile
 
 bool Interval::Item::exec() {
-  data->interval_type = 0;
-
-  LOOP_START(data->param.coords.begin(), data->param.coords.end(), it);
-  auto i = it.key();
-  if (data->param.H[i] >= data->param.H_null[i])
-    data->interval_type = std::max(data->interval_type, 1);
-  else if (data->param.H_null[i] > data->param.H[i] && data->param.H[i] > 0)
-    data->interval_type = std::max(data->interval_type, 2);
-  else if (0 > data->param.H[i])
-    data->interval_type = 3;
-  LOOP_END;
+  // Тип интервала определяется по экстремумам просветов, сведенным при
+  // расчете профиля
+  data->interval_type =
+      Kernel::intervalType(data->param.extrema, data->param.track);
 
   switch (data->interval_type) {
     case (1):
@@ -795,7 +630,6 @@ bool Interval::Item::exec() {
       colourArea(255, 50, 50, 30);
       break;
   }
-  if (!_data) return false;
   return true;
 }
 
@@ -819,361 +653,93 @@ namespace Land {
 // Составляющая расчета. Реализация расчета затухания на открытом интервале
 
 bool Opened::exec() {
-  const auto point = _findPointOfIntersection();
-  double l_null_length =  ///< Длина участка отражения
-      lNull(data->param.h_null[point.first], k(point.first));
-
-  // Если длина участка отражения <= 1/4 длины всего интервала
-  double delta_r =  ///< Разность хода между прямым и отраженным лучами
-      (l_null_length <= 0.25 * data->constant.area_length)
-          ? _planeApproximation(point)
-          : _sphereApproximation(
-                coords.lowerBound(point.first - l_null_length / 2),
-                coords.lowerBound(point.first + l_null_length / 2));
-
-  double p =  ///< Относительный просвет в точке отражения
-      qSqrt(6 * delta_r * data->constant.lambda);
-
-  data->wp = _atten(
-      _relief(
-          data->param.coordsAndEarth.lowerBound(point.first - l_null_length),
-          data->param.coordsAndEarth.lowerBound(point.first + l_null_length)),
-      p);
-
-  if (!_data) return false;
-  return true;
-}
+  const Diffraction::Point tx = {data->tower.f.x(),
+                                 data->tower.f.y() + coords.startY()};
+  const Diffraction::Point rx = {data->tower.s.x(),
+                                 data->tower.s.y() + coords.endY()};
 
-QPair<int, int> Opened::_findPointOfIntersection(void) {
-  double oppositendY_coord =  ///< Ордината точки, зеркальной к передатчику
-                              ///< относительно высотного профиля
-      coords.startY() - data->tower.f.y();
-
-  auto pair =  ///< Линия, проведенная к зеркальной точке
-      strLineEquation(coords.startX(), oppositendY_coord, coords.endX(),
-                      data->tower.s.y() + coords.endY());
-
-  double inters_x;  ///< Индекс наивысшей точки пересечения высотного
-  ///< профиля и прямой, проведенной из точки приемника к точке, зеркальной
-  ///< передатчику
-  double inters_y;  ///< Ордината точки пересечения
-
-  // Поиск точки пересечения высотного профиля и линии, проведенной к зеркальной
-  // точке. Если точек несколько, то берется последняя в цикле точка
-  LOOP_START(std::next(data->param.coordsAndEarth.begin()),
-             std::prev(data->param.coordsAndEarth.end()), it);
-  auto y_coord = pair.first * it.key() + pair.second;
-  if ((y_coord >= (it - 1).value() && y_coord <= (it + 1).value()) ||
-      (y_coord <= (it - 1).value() && y_coord >= (it + 1).value())) {
-    inters_y = y_coord;
-    inters_x = it.key();
-  }
-  LOOP_END;
-  return {inters_x, inters_y};
-}
-
-double Opened::_planeApproximation(QPair<int, int> intersec) {
-  return qPow(data->param.H[intersec.first], 2) /
-         (2 * data->constant.area_length * k(intersec.first) *
-          (1 - k(intersec.first)));
-}
+  Diffraction::Workspace w;
+  data->wp = Diffraction::interference(data->param.track, tx, rx,
+                                       data->constant.lambda,
+                                       data->constant.reflection_coef, w);
+  data->reflections = w.reflections;
 
-double Opened::_sphereApproximation(iter begin, iter end) {
-  auto min_h = std::min_element(data->param.H.lowerBound(begin.key()),
-                                data->param.H.lowerBound(end.key()));
-
-  return data->param.h_null.lowerBound(min_h.key()).value();
-}
-
-double Opened::_relief(iter begin, iter end) {
-  auto line =
-      strLineEquation(begin.key(), begin.value(), end.key(), end.value());
-
-  int res = 0;
-  double delta_h_max = 0;
-  for (auto it = begin; it != end; ++it) {
-    double delta_h = (line.second * it.key() - line.first);
-    double h_max =
-        0.75 * (data->param.H_null[it.key()] - data->param.h_null[it.key()]);
-    if (delta_h <= h_max)
-      continue;
-    else if (delta_h < data->param.H_null[it.key()])
-      res = std::min(res, 1);
-    else
-      res = 2;
-    delta_h_max = std::max(delta_h_max, delta_h);
-  }
-  if (qAbs(delta_h_max) - .1 <= 0) res = 3;
-
-  return res == 0 ? 1
-                  : data->constant.reflection_coef.lowerBound(
-                        data->constant.lambda) ==
-                            data->constant.reflection_coef.end()
-                        ? data->constant.reflection_coef.last()[res - 1]
-                        : data->constant.reflection_coef
-                              .lowerBound(data->constant.lambda)
-                              .value()[res - 1];
+  return true;
 }
 
-double Opened::_atten(double phi_null, double p) {
-  return -10 * log10(1 + qPow(phi_null, 2) -
-                     2 * qPow(phi_null, 2) * qCos(2 * M_PI * (p * p) / 3));
-}  // Конец реализации расчета затухания на открытом интервале
+// Конец реализации расчета затухания на открытом интервале
 
 // Составляющая расчета. Реализация расчета затухания на полуоткрытом интервале
 
 bool SemiOpened::exec() {
-  auto shad = _shadingObstacle();  ///< Координаты затеняющего препятствия
-  data->wp = _atten(_tangent(shad));
+  data->wp = Diffraction::shading(data->param.track, data->constant.lambda);
 
-  if (!_data) return false;
   return true;
 }
 
-QPair<double, double> SemiOpened::_shadingObstacle(void) const {
-  auto H = data->param.H.toStdMap();
-  auto min_H = std::min_element(H.begin(), H.end(),
-                                [&](const std::pair<double, double> &lhs,
-                                    const std::pair<double, double> &rhs) {
-                                  return rhs.second > lhs.second;
-                                });
-  auto p = data->param.coordsAndEarth.lowerBound(min_H->first);
-
-  return {p.key(), p.value()};
-}
-
-double SemiOpened::_tangent(const QPair<double, double> &p) {
-  auto line_l =
-      strLineEquation(coords.startX(), coords.startY(), p.first, p.second);
-  auto line_r =
-      strLineEquation(coords.endX(), coords.endY(), p.first, p.second);
-
-  auto poi = _pointOfIntersection(line_l, line_r);
-  double h =  ///< Возвышение препятствия над ЛПВ
-      poi.second - data->param.los.first * poi.first - data->param.los.second;
-  double d1 =  ///< Расстояние от левого конца трассы интервала до препятствия
-      qSqrt(qPow(poi.second - coords.startY(), 2) +
-            qPow(poi.first - coords.startX(), 2));
-  double d2 =  ///< Расстояние от правого конца трассы интервала до препятствия
-      qSqrt(qPow(poi.second - coords.endY(), 2) +
-            qPow(poi.first - coords.endX(), 2));
-  return _diffractionParam(h, d1, d2);
-}
-
-QPair<double, double> SemiOpened::_pointOfIntersection(
-    QPair<double, double> l, QPair<double, double> r) const {
-  double x = (r.second - l.second) / (l.first - r.first);
-  double y = l.first * x + l.second;
-  return {x, y};
-}
-
-double SemiOpened::_diffractionParam(double h, double d1, double d2) const {
-  return h * qSqrt(2 * (d1 + d2) / (data->constant.lambda * d1 * d2));
-}
-
-double SemiOpened::_atten(double param) const {
-  if (param <= -.7)
-    return 0;
-  else
-    return 6.9 + 20 * log10(qSqrt(qPow((param - .1), 2) + 1) + param - .1);
-}
-
 // Конец реализации расчета затухания на полуоткрытом интервале
 
 // Составляющая расчета. Реализация расчета затухания на закрытом интервале
 
 bool Closed::exec() {
-  Peaks l = _countPeaks();
+  const Diffraction::Point tx = {data->tower.f.x(),
+                                 data->tower.f.y() + coords.startY()};
+  const Diffraction::Point rx = {data->tower.s.x(),
+                                 data->tower.s.y() + coords.endY()};
 
-  data->wp = _atten(_reliefTangentStraightLines(l));
+  const Diffraction::Result r = Diffraction::loss(
+      data->param.track, tx, rx, data->constant.lambda, data->diffraction);
+  data->wp = r.wp;
+  data->edges = r.edges;
 
-  if (!_data) return false;
   return true;
 }
 
-auto Closed::_countPeaks() -> Peaks {
-  Peaks v;
-  double p;
-  bool inside = 0;
-  LOOP_START(data->param.coordsAndEarth.begin(),
-             data->param.coordsAndEarth.end(), it);
-  if (it.value() >=
-          (data->param.los.first * it.key() + data->param.los.second) &&
-      inside == 0) {
-    p = it.key();
-    inside = 1;
-  } else if (it.value() <=
-                 (data->param.los.first * it.key() + data->param.los.second) &&
-             inside == 1) {
-    inside = 0;
-    v.push_back(qMakePair(p, it.key()));
-  }
-  LOOP_END;
-
-  _approx(v);  // Аппроксимация нескольких участков одним
-
-  return v;
-}  // namespace Calc
-
-void Closed::_approx(Peaks &v) {
-  auto coord = data->param.coordsAndEarth.toStdMap();
-
-  LOOP_START(v.begin(), v.end() - 1, it);
-  auto r1 =  ///< Расстояние до вершины первого препятствия
-      std::distance(coord.begin(),
-                    std::max_element(std::next(coord.begin(), it->first),
-                                     std::next(coord.begin(), it->second),
-                                     [](const std::pair<int, int> &p1,
-                                        const std::pair<int, int> &p2) {
-                                       return p1.second < p2.second;
-                                     }));
-
-  auto r2 =  ///< Расстояние до вершины второго препятствия
-      std::distance(
-          coord.begin(),
-          std::max_element(
-              std::next(coord.begin(), std::next(it)->first),
-              std::next(coord.begin(), std::next(it)->second),
-              [](const std::pair<int, int> &p1, const std::pair<int, int> &p2) {
-                return p1.second < p2.second;
-              }));
-
-  // Условие аппроксимации
-  if (log10(M_PI - qAsin(qSqrt(data->constant.area_length * (r2 - r1) /
-                               (r2 * (data->constant.area_length - r1))))) >
-      0.408) {
-    (it + 1)->first = it->first;
-    v.erase(it);
-  }
-  LOOP_END;
-}
-
-double Closed::_reliefTangentStraightLines(const Peaks &p) {
-  QPair<double, double> left,  ///< Координаты высшей точки левого препятствия
-      right;  ///< Координаты высшей точки правого препятствия
-  Peaks peaks;
-  double diffraction_param = 0;
-  auto coord = data->param.coordsAndEarth;
-
-  // Находим для каждого препятствия координаты его высшей точки
-  for (auto &it : qAsConst(p)) {
-    double max_x = -1, max_y = -1;
-    for (auto i = it.first; i <= it.second; ++i) {
-      if (max_y < coord[i]) max_y = coord[i], max_x = i;
-    }
-    peaks.push_back({max_x, max_y});
-  }
-
-  LOOP_START(peaks.begin(), peaks.end(), it);
-  left = (it == peaks.begin())
-             ? qMakePair(data->tower.f.x(),
-                         data->tower.f.y() + data->param.coords.startY())
-             : *(it - 1);
-  right = (it == peaks.end() - 1)
-              ? qMakePair(data->tower.s.x(),
-                          data->tower.s.y() + data->param.coords.endY())
-              : *(it + 1);
-  diffraction_param += _tangent(*it, left, right);
-  LOOP_END;
-
-  return diffraction_param;
-}
-
-double Closed::_tangent(const QPair<double, double> &p,
-                        const QPair<double, double> &left,
-                        const QPair<double, double> &right) {
-  QPair<double, double> line_l, line_r;
+// Конец реализации расчета затухания на закрытом интервале
 
-  // Поиск касательной со стороны левого препятствия
-  for (auto it = (data->param.coordsAndEarth.lowerBound(left.first) + 1);
-       it != data->param.coordsAndEarth.end(); ++it) {
-    line_l = strLineEquation(left.first, left.second, it.key(), it.value());
-    if (_isTangent(line_l.first, line_l.second, it.key(), coords.endX())) break;
-  }
-
-  // Поиск касательной со стороны правого препятствия
-  for (auto it = (data->param.coordsAndEarth.lowerBound(right.first) - 1);
-       it != data->param.coordsAndEarth.begin(); --it) {
-    line_r = strLineEquation(right.first, right.second, it.key(), it.value());
-    if (_isTangent(line_r.first, line_r.second, coords.startX(), it.key()))
-      break;
-  }
-
-  auto poi = _pointOfIntersection(line_l, line_r);
-
-  if (poi != QPair<double, double>(0, 0)) {
-    double h =  ///< Возвышение препятствия над ЛПВ
-        poi.second - data->param.los.first * poi.first - data->param.los.second;
-
-    double d1 =  ///< Расстояние от левого конца трассы интервала до препятствия
-        qSqrt(qPow(poi.second - left.second, 2) +
-              qPow(poi.first - left.first, 2));
-
-    double
-        d2 =  ///< Расстояние от правого конца трассы интервала до препятствия
-        qSqrt(qPow(poi.second - right.second, 2) +
-              qPow(poi.first - right.first, 2));
-    return _diffractionParam(h, d1, d2);
-  } else
-    return 0;
-}
+}  // namespace Land
 
-QPair<double, double> Closed::_pointOfIntersection(
-    const QPair<double, double> &l, const QPair<double, double> &r) {
-  // Если уравнения прямых совпадают
-  if (l == r) return {0, 0};
+bool Free::Item::exec() {
+  data->ws =
+      Budget::freeSpace(data->constant.area_length, data->constant.lambda);
 
-  double x = (r.second - l.second) / (l.first - r.first);
-  double y = l.first * x + l.second;
-  return {x, y};
+  return true;
 }
 
-double Closed::_diffractionParam(double h, double d1, double d2) {
-  return h * qSqrt(2 * (d1 + d2) / (data->constant.lambda * d1 * d2));
-}
+bool Air::Item::exec() {
+  Atmosphere::Conditions c;
+  c.temperature = data->constant.temperature;
+  c.pressure = data->constant.pressure;
+  c.humidity = data->constant.humidity;
+  const Atmosphere::Gamma g =
+      Atmosphere::Table::instance().gamma(data->spec.f / 1000.0, c);
+  data->wa = (data->constant.area_length / 1000.0) * g.total();
 
-double Closed::_atten(double param) {
-  if (param <= -.7)
-    return 0;
-  else
-    return 6.9 + 20 * log10(qSqrt(qPow((param - .1), 2) + 1) + param - .1);
+  return true;
 }
 
-}  // namespace Land
-
-bool Free::Item::exec() {
-  data->ws = 122 + 20 * log10((data->constant.area_length / 1e+3) /
-                              (data->constant.lambda * 1e+2));
+bool Rain::Item::exec() {
+  Atmosphere::Rain::Link link;
+  link.f = data->spec.f / 1000.0;
+  link.length = data->constant.area_length / 1000.0;
+  link.rate = data->constant.rain_rate;
+  link.tau = data->constant.polarization;
 
-  if (!_data) return false;
-  return true;
-}
+  // Проценты времени для отображения и процент, допустимый по вероятности
+  // связи, рассчитываются за один проход
+  QVector<double> p = data->constant.rain_percentages;
+  p.push_back(100 - data->spec.prob);
+  data->wr_p = Atmosphere::Rain::attenuation(link, p);
+  data->wr = data->wr_p.takeLast();
 
-bool Air::Item::exec() {
-  double f = data->spec.f / 1000.0;
-  double gamma_oxygen =
-      (6.09 / (f * f + .227) + 7.19e-3 + 4.81 / (qPow(f - 57, 2) + 1.5)) * f *
-      f * 1e-3;
-  double gamma_water =
-      (.05 + 3.6 / (qPow(f - 22.2, 2) + 8.5) + 21e-4 * 7.5 +
-       10.6 / (qPow(f - 188.3, 2) + 9) + 8.9 / (qPow(f - 325.4, 2) + 26.3)) *
-      f * f * 7.5 * 1e-4;
-  data->wa = (data->constant.area_length / 1000.0) *
-             ((1 - (data->constant.temperature - 15) * .01) * gamma_oxygen +
-              (1 - (data->constant.temperature - 15) * .06) * gamma_water);
-
-  if (!_data) return false;
   return true;
 }
 
 bool Acceptable::Item::exec() {
-  double to_uv =
-      qPow(10.0, ((abs(data->spec.s.first) > abs(data->spec.s.second))
-                      ? data->spec.s.first
-                      : data->spec.s.second) /
-                     20.0);
-
-  double to_dbvt = 10 * log10(qPow(to_uv * 1e-6, 2) / 50);
+  const double to_dbvt =
+      Budget::toDbvt((abs(data->spec.s.first) > abs(data->spec.s.second))
+                         ? data->spec.s.first
+                         : data->spec.s.second);
 
   data->spec.q = std::min(data->p.first, data->p.second) - to_dbvt;
 
@@ -1185,7 +751,10 @@ bool Acceptable::Item::exec() {
       QString::number(data->wp));
   data->mainWindow->concStockValueLabel->setText(QString::number(data->spec.q));
 
-  if (data->spec.q < 0 || data->spec.q < getStock(100 - data->spec.prob) ||
+  data->stock =
+      data->spec.stocks(data->spec.f, 100 - data->spec.prob) + data->wr;
+
+  if (data->spec.q < 0 || data->spec.q < data->stock ||
       data->spec.f < 60 || data->spec.f > 645) {
     data->mainWindow->concConcValueLabel->setText(
         QObject::tr("Связи не будет"));
@@ -1197,37 +766,24 @@ bool Acceptable::Item::exec() {
         "QLabel { background-color : green; color : white; }");
   }
 
-  if (!_data) return false;
   return true;
 }
 
-double Acceptable::Item::getStock(double t) {
-  auto line = *data->spec.depend.lowerBound(data->spec.f);
-
-  auto lhs = std::find_if(line.begin(), line.end(),
-                          [&](const QPointF &q) { return q.y() >= t; });
-
-  auto rhs = std::prev(lhs);
-
-  auto p = strLineEquation(lhs->x(), lhs->y(), rhs->x(), rhs->y());
-
-  return (t - p.second) / p.first;
-}
-
 }  // namespace Atten
 
 namespace Median {
 
 bool Item::exec() {
-  auto data = _data.toStrongRef();
-
-  data->p.first = fromVtToDbvt(data->spec.p.first) - data->tower.wf.first +
-                  data->tower.c.first - data->wp - data->ws - data->wa +
-                  data->tower.c.second - data->tower.wf.second;
+  const double w = data->wp + data->ws + data->wa;
+  data->p.first =
+      Budget::level(data->spec.p.first, data->tower.wf.first,
+                    data->tower.c.first, w, data->tower.c.second,
+                    data->tower.wf.second);
 
-  data->p.second = fromVtToDbvt(data->spec.p.second) - data->tower.wf.second +
-                   data->tower.c.second - data->wp - data->ws - data->wa +
-                   data->tower.c.first - data->tower.wf.first;
+  data->p.second =
+      Budget::level(data->spec.p.second, data->tower.wf.second,
+                    data->tower.c.second, w, data->tower.c.first,
+                    data->tower.wf.first);
 
   data->log_p.first = C(fromVtToDbvt(data->spec.p.first)) -
                       C(data->tower.wf.first) + C(data->tower.c.first) -
@@ -1239,7 +795,6 @@ bool Item::exec() {
                        C(data->wp) - C(data->ws) - C(data->wa) +
                        C(data->tower.c.first) - C(data->tower.wf.first);
 
-  if (!_data) return false;
   return true;
 }
 
@@ -1248,29 +803,40 @@ bool Item::exec() {
 namespace Sesr {
 
 bool Item::exec() {
-  data->spec.sesrc + data->spec.sesrg;
-  if (!_data) return false;
+  if (!Pipeline<Sesrg, Sesrc>::exec(*data))
+    return false;
+  data->spec.sesr = data->spec.sesrg + data->spec.sesrc;
+
   return true;
 }
 
 bool Sesrg::exec() {
   double h_avg = (data->tower.f.y() + data->tower.s.y()) / 2;
 
-  double c = 5 - .007 * h_avg + 4e-6 * h_avg * h_avg;
+  double p_null =
+      Outage::occurrence(data->spec.f / 1000.0,
+                         data->constant.area_length / 1000.0,
+                         Outage::climate(h_avg));
+  // Вероятность возникновения замираний задана в процентах, SESR - доля
+  // времени
+  data->spec.sesrg = p_null * qPow(10, -.1 * data->spec.q) / 100;
 
-  double p_null = data->constant.area_length > 20
-                      ? 4.1e-4 * c * qPow(data->spec.f, 1.5) *
-                            qPow(data->constant.area_length, 2)
-                      : 2.05e-5 * c * qPow(data->spec.f, 1.5) *
-                            qPow(data->constant.area_length, 3);
-  data->spec.sesrg = p_null * qPow(10, -.1 * data->spec.q);
-
-  if (!_data) return false;
   return true;
 }
 
 bool Sesrc::exec() {
-  if (!_data) return false;
+  Atmosphere::Rain::Link link;
+  link.f = data->spec.f / 1000.0;
+  link.length = data->constant.area_length / 1000.0;
+  link.rate = data->constant.rain_rate;
+  link.tau = data->constant.polarization;
+
+  // Доля времени, в течение которой затухание в дожде превышает запас
+  QVector<double> p;
+  Atmosphere::Rain::Batch(QVector<Atmosphere::Rain::Link>(1, link))
+      .percentage(QVector<double>(1, data->spec.q), p);
+  data->spec.sesrc = p.first() / 100;
+
   return true;
 }
 
@@ -1280,14 +846,25 @@ Core::Core(Ui::NRrlsMainWindow *m, const QString &filename) {
   data = QSharedPointer<Data>::create();
   data->mainWindow = m;
   data->filename = filename;
-  _main = Main::Item::Ptr::create(data);
 }
 
-bool Core::exec() { return _main->exec(); }
+bool Core::exec() { return Main::Item(*data).exec(); }
 
 void Core::setFreq(double f) {
   data->spec.f = f;
   data->constant.lambda = (double)3e+8 / (f * 1e+6);
+  invalidate(Input::Freq);
+}
+
+void Core::setZones(const QVector<Kernel::Zone> &zones) {
+  data->zones = zones;
+  invalidate(Input::Freq);
+}
+
+void Core::invalidate(int input) {
+  data->changed |= input;
+  if (input & (Input::File | Input::Gradient))
+    data->pyramid = Coarse::Pyramid();
 }
 
 double Core::coordX(double c) {
@@ -1306,6 +883,302 @@ double Core::yRange() {
   return data->mainWindow->customplot->yAxis->range().size();
 }
 
+bool Core::series(const QString &filename, Series::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  QVector<Series::Sample> samples;
+  if (!Series::read(filename, samples)) return false;
+
+  r = Series::evaluate(_link(), samples);
+  return true;
+}
+
+bool Core::monteCarlo(MonteCarlo::Options o, MonteCarlo::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  o.gradient = data->constant.g_standard;
+  r = MonteCarlo::run(_link(), o);
+  return true;
+}
+
+bool Core::sensitivity(Budget::Outputs<Budget::Dual> &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  r = Budget::sensitivity(_path(), _inputs());
+  return true;
+}
+
+bool Core::bounds(const Budget::Inputs<double> &spread,
+                  Budget::Outputs<IA::Interval> &r, IA::Interval &excess,
+                  bool &stable) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  const Budget::Inputs<double> c = _inputs();
+  auto iv = [](double v, double d) {
+    return IA::Interval(v - qAbs(d), v + qAbs(d));
+  };
+  Budget::Inputs<IA::Interval> in;
+  in.h1 = iv(c.h1, spread.h1);
+  in.h2 = iv(c.h2, spread.h2);
+  in.f = iv(c.f, spread.f);
+  in.g = iv(c.g, spread.g);
+  in.p1 = iv(c.p1, spread.p1);
+  in.p2 = iv(c.p2, spread.p2);
+  in.c1 = iv(c.c1, spread.c1);
+  in.c2 = iv(c.c2, spread.c2);
+  in.wf1 = iv(c.wf1, spread.wf1);
+  in.wf2 = iv(c.wf2, spread.wf2);
+  in.s = iv(c.s, spread.s);
+  r = Budget::bounds(_path(), in, stable);
+
+  Atmosphere::Rain::Link rain;
+  rain.f = data->spec.f / 1000.0;
+  rain.length = data->constant.area_length / 1000.0;
+  rain.rate = data->constant.rain_rate;
+  rain.tau = data->constant.polarization;
+  const double percent = 100 - data->spec.prob;
+  excess = r.q - data->spec.stocks(in.f, percent) -
+           Atmosphere::Rain::attenuation(rain, in.f / 1000.0, percent);
+  return true;
+}
+
+Budget::Inputs<double> Core::_inputs() const {
+  Budget::Inputs<double> in;
+  in.h1 = data->tower.f.y();
+  in.h2 = data->tower.s.y();
+  in.f = data->spec.f;
+  in.g = data->constant.g_standard;
+  in.p1 = data->spec.p.first;
+  in.p2 = data->spec.p.second;
+  in.c1 = data->tower.c.first;
+  in.c2 = data->tower.c.second;
+  in.wf1 = data->tower.wf.first;
+  in.wf2 = data->tower.wf.second;
+  in.s = (abs(data->spec.s.first) > abs(data->spec.s.second))
+             ? data->spec.s.first
+             : data->spec.s.second;
+  return in;
+}
+
+bool Core::band(const QVector<double> &f, Band::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  QVector<double> stock(f.size());
+  for (int j = 0; j < f.size(); ++j)
+    stock[j] = data->spec.stocks(f[j], 100 - data->spec.prob);
+
+  r = Band::evaluate(_band(), f, stock);
+  return true;
+}
+
+bool Core::heights(const Heights::Options &o, Heights::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  const double stock = data->spec.stocks(data->spec.f, 100 - data->spec.prob);
+  r = Heights::optimize(_band(), data->spec.f, stock, o);
+  return true;
+}
+
+bool Core::heightMap(const HeightMap::Options &o, HeightMap::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  const double stock = data->spec.stocks(data->spec.f, 100 - data->spec.prob);
+  r = HeightMap::evaluate(_band(), data->spec.f, stock, o);
+  return true;
+}
+
+bool Core::coarse(const Coarse::Options &o, Coarse::Result &r) {
+  const auto &track = data->param.track;
+  if (track.x.isEmpty()) return false;
+
+  Kernel::Params p;
+  p.area_length = data->constant.area_length;
+  p.lambda = data->constant.lambda;
+  p.equivalent_radius = Kernel::equivalentRadius(data->constant.radius,
+                                                 data->constant.g_standard);
+  const double x1 = data->tower.f.x(), x2 = data->tower.s.x();
+  const double y1 = data->tower.f.y() + track.y.first(),
+               y2 = data->tower.s.y() + track.y.last();
+  const double a = (y2 - y1) / (x2 - x1);
+  p.los = {a, y1 - x1 * a};
+
+  // Наибольший коэффициент отражения для текущей длины волны
+  Coarse::Options co = o;
+  const auto &c = data->constant.reflection_coef;
+  if (!c.isEmpty()) {
+    auto it = c.lowerBound(p.lambda);
+    const QVector<double> &row = it == c.end() ? c.last() : it.value();
+    co.phi = row.isEmpty() ? 1 : *std::max_element(row.begin(), row.end());
+  }
+
+  co.diffraction = data->diffraction;
+
+  if (data->pyramid.isEmpty()) {
+    data->pyramid = Coarse::Pyramid(p, track);
+    data->scratch.x = track.x;
+    data->scratch.y = track.y;
+  }
+  r = data->pyramid.evaluate(p, co);
+  if (r.wp.width() <= o.tolerance) return true;
+
+  // Границы шире допустимых: затухание рассчитывается по полному профилю
+  auto &t = data->scratch;
+  Kernel::profilePass(p, t);
+  Diffraction::Workspace w;
+  switch (r.type) {
+    case 1:
+      r.wp = Diffraction::interference(t, {x1, y1}, {x2, y2}, p.lambda, c, w);
+      break;
+    case 2:
+      r.wp = Diffraction::shading(t, p.lambda);
+      break;
+    case 3:
+      r.wp = Diffraction::loss(t, {x1, y1}, {x2, y2}, p.lambda,
+                               data->diffraction, w);
+      break;
+  }
+  return true;
+}
+
+bool Core::inverse(Inverse::Result &r) {
+  if (data->param.track.x.isEmpty()) return false;
+
+  const Budget::Inputs<double> in = _inputs();
+  Inverse::Link l;
+  l.p = data->spec.p;
+  l.c = data->tower.c;
+  l.wf = data->tower.wf;
+  l.ws = data->ws;
+  l.wa = data->wa;
+  l.wp = data->wp;
+  l.s = in.s;
+
+  Atmosphere::Rain::Link rain;
+  rain.f = data->spec.f / 1000.0;
+  rain.length = data->constant.area_length / 1000.0;
+  rain.rate = data->constant.rain_rate;
+  rain.tau = data->constant.polarization;
+
+  r = Inverse::evaluate(
+      l, Inverse::Required(data->spec.stocks, data->spec.f, rain),
+      data->spec.prob);
+  return true;
+}
+
+bool Core::refraction(const QVector<Refraction::Level> &levels,
+                      Kernel::Track &t, Kernel::Extrema &e) {
+  const auto &track = data->param.track;
+  if (track.x.isEmpty()) return false;
+
+  // g_standard - градиент диэлектрической проницаемости, как в
+  // Kernel::equivalentRadius, Refraction принимает градиент N = (n - 1) * 1e6
+  const Refraction::Profile p =
+      levels.size() >= 2
+          ? Refraction::Profile(levels, data->constant.radius)
+          : Refraction::Profile::linear(data->constant.g_standard / 2 * 1e+6,
+                                        data->constant.radius);
+  t = Kernel::Track();
+  t.x = track.x;
+  t.y = track.y;
+  e = Refraction::clearance(
+      p, {data->tower.f.x(), data->tower.f.y() + track.y.first()},
+      {data->tower.s.x(), data->tower.s.y() + track.y.last()},
+      data->constant.lambda, t);
+  return true;
+}
+
+bool Core::hop(Chain::Site &first, Chain::Site &second, Chain::Hop &h) const {
+  if (data->param.track.x.isEmpty()) return false;
+
+  first.height = data->tower.f.y();
+  first.power = data->spec.p.first;
+  first.gain = data->tower.c.first;
+  first.feeder = data->tower.wf.first;
+  first.sensitivity = data->spec.s.first;
+  second.height = data->tower.s.y();
+  second.power = data->spec.p.second;
+  second.gain = data->tower.c.second;
+  second.feeder = data->tower.wf.second;
+  second.sensitivity = data->spec.s.second;
+
+  h.track.x = data->param.track.x;
+  h.track.y = data->param.track.y;
+  h.f = data->spec.f;
+  h.rain_rate = data->constant.rain_rate;
+  h.polarization = data->constant.polarization;
+  return true;
+}
+
+Series::Link Core::_link() const {
+  const auto &track = data->param.track;
+
+  Series::Link link;
+  link.params.area_length = data->constant.area_length;
+  link.params.lambda = data->constant.lambda;
+  link.params.los = data->param.los;
+  link.track.x = track.x;
+  link.track.y = track.y;
+  link.radius = data->constant.radius;
+  link.tx = {data->tower.f.x(), data->tower.f.y() + track.y.first()};
+  link.rx = {data->tower.s.x(), data->tower.s.y() + track.y.last()};
+  link.diffraction = data->diffraction;
+  link.f = data->spec.f / 1000.0;
+  link.pressure = data->constant.pressure;
+  link.level = data->spec.q + data->wp + data->wa;
+  link.reflection_coef = data->constant.reflection_coef;
+  link.stock = data->stock;
+  return link;
+}
+
+Budget::Path Core::_path() const {
+  const auto &track = data->param.track;
+
+  Budget::Path p;
+  p.x = track.x;
+  p.y = track.y;
+  p.radius = data->constant.radius;
+  p.atmosphere.temperature = data->constant.temperature;
+  p.atmosphere.pressure = data->constant.pressure;
+  p.atmosphere.humidity = data->constant.humidity;
+  p.type = data->interval_type;
+  for (const Kernel::Reflection &r : data->reflections) {
+    if (r.wp < data->wp) continue;
+    p.reflection = r.idx;
+    p.sphere = r.sphere;
+    p.phi_null = r.phi_null;
+    break;
+  }
+  p.shading = std::min_element(track.H.begin(), track.H.end()) -
+              track.H.begin();
+  p.diffraction = data->diffraction;
+  p.edges = data->edges;
+  return p;
+}
+
+Band::Link Core::_band() const {
+  const auto &track = data->param.track;
+
+  Band::Link link;
+  link.params.area_length = data->constant.area_length;
+  link.params.equivalent_radius = Kernel::equivalentRadius(
+      data->constant.radius, data->constant.g_standard);
+  link.params.los = data->param.los;
+  link.track.x = track.x;
+  link.track.y = track.y;
+  link.tx = {data->tower.f.x(), data->tower.f.y() + track.y.first()};
+  link.rx = {data->tower.s.x(), data->tower.s.y() + track.y.last()};
+  link.diffraction = data->diffraction;
+  link.atmosphere.temperature = data->constant.temperature;
+  link.atmosphere.pressure = data->constant.pressure;
+  link.atmosphere.humidity = data->constant.humidity;
+  link.reflection_coef = data->constant.reflection_coef;
+  link.gain = data->spec.q + data->wp + data->ws + data->wa;
+  link.rain_rate = data->constant.rain_rate;
+  link.polarization = data->constant.polarization;
+  link.percent = 100 - data->spec.prob;
+  return link;
+}
+
 }  // namespace Calc
 
 }  // namespace NRrls
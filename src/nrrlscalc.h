@@ -6,7 +6,23 @@
 #include <iostream>
 #include <utility>
 
+#include "nrrlsatmosphere.h"
+#include "nrrlsband.h"
+#include "nrrlschain.h"
+#include "nrrlsbudget.h"
+#include "nrrlscoarse.h"
+#include "nrrlsdiffraction.h"
 #include "nrrlsgraphpainter.h"
+#include "nrrlsheightmap.h"
+#include "nrrlsheights.h"
+#include "nrrlsinverse.h"
+#include "nrrlskernel.h"
+#include "nrrlsmontecarlo.h"
+#include "nrrlsoutage.h"
+#include "nrrlspipeline.h"
+#include "nrrlsrefraction.h"
+#include "nrrlsseries.h"
+#include "nrrlsstock.h"
 
 #include "ui_nrrlscoordswindow.h"
 #include "ui_nrrlsdiagramwindow.h"
@@ -14,8 +30,6 @@
 #include "ui_nrrlsmainwindow.h"
 #include "ui_nrrlssecondstationwidget.h"
 
-#define QSHDEF(x) typedef QSharedPointer<x> Ptr
-
 #define LOOP_START(begin, end, it) \
   loop(begin, end, [&](decltype(begin) it) {
 #define LOOP_END \
@@ -53,6 +67,32 @@ void loop(Iterator begin, Iterator end, Func f) {
 namespace NRrls {
 namespace Calc {
 
+/**
+ * Входные параметры расчета. Каждая составляющая расчета объявляет, от каких
+ * из них она зависит, и перезапускается только при их изменении
+ */
+namespace Input {
+
+enum Flag {
+  None = 0x000,
+  File = 0x001,         ///< Файл высотного профиля
+  Gradient = 0x002,     ///< Вертикальный градиент индекса преломления
+  Heights = 0x004,      ///< Высоты подвеса антенн
+  Freq = 0x008,         ///< Частота
+  Temperature = 0x010,  ///< Температура
+  Power = 0x020,        ///< Мощность передатчиков
+  Gain = 0x040,         ///< Коэффициенты усиления антенн
+  Feeder = 0x080,       ///< Затухания в фидерах
+  Sensitivity = 0x100,  ///< Чувствительность приемников
+  Prob = 0x200,         ///< Вероятность связи
+  Pressure = 0x400,     ///< Атмосферное давление
+  Humidity = 0x800,     ///< Плотность водяного пара
+  Rain = 0x1000,        ///< Интенсивность дождя и поляризация
+  All = 0x1fff
+};
+
+}  // namespace Input
+
 namespace Const {
 
 /**
@@ -65,6 +105,14 @@ struct Data {
   double area_length = 0;  ///< Длина рассматриваемого участка (в метрах)
   const double radius = 6.37e+06;  ///< Действительный радиус Земли (в метрах)
   double temperature = 0;
+  double pressure = 1013.25;  ///< Атмосферное давление (в гПа)
+  double humidity = 7.5;      ///< Плотность водяного пара (в г/м3)
+  double rain_rate = 0;  ///< Интенсивность дождя, превышаемая 0,01% времени
+                         ///< (в мм/ч)
+  double polarization = 0;  ///< Угол наклона поляризации (в градусах)
+  QVector<double> rain_percentages = {.001, .01, .1, 1};  ///< Проценты
+                                                          ///< времени
+                                                          ///< (дождь)
 
   const QMap<double, QVector<double>> reflection_coef = {{{0.015, {.2, .1, .6}},
                                                           {0.03, {.45, .1, .6}},
@@ -85,8 +133,10 @@ struct Data {
   double f = 0;     ///< Частота
   double q = 0;     ///< Надежность (Запас) связи
   double prob = 0;  ///< Вероятность связи
-  double sesrg = 0;
-  double sesrc = 0;
+  double sesrg = 0;  ///< SESR из-за интерференционных замираний (доля
+                     ///< времени)
+  double sesrc = 0;  ///< SESR из-за дождя (доля времени)
+  double sesr = 0;   ///< Суммарный SESR (доля времени)
   QPair<double, double> p = {0, 0};  ///< Мощность
   QPair<double, double> s = {0, 0};  ///< Чувствительность
 
@@ -111,7 +161,7 @@ struct Data {
         {QObject::tr("БУК"), 6},
         {QObject::tr("А6-5"), 10}}}};
 
-  using GraphDots = QVector<QPointF>;
+  using GraphDots = Stock::Curve;
 
   const QMap<double, GraphDots> depend = {
       {100, {{11, 0}, {10, .04}, {8, .3}, {6, 2}, {4, 10}, {0, 50}}},
@@ -165,6 +215,9 @@ struct Data {
         {6, 20},
         {4, 30},
         {0, 50}}}};
+
+  const Stock::Table stocks = Stock::Table(depend);  ///< Требуемые запасы
+                                                     ///< по depend
 };
 
 }  // namespace Spec
@@ -237,6 +290,8 @@ struct Data {
   QMap<double, double> H_null;  ///< Критические просветы
   QMap<double, double> H;  ///< Расстояние между ЛПВ и линией профиля местности
   size_t count;  ///< Количество точек разбиения
+  Kernel::Track track;  ///< Высотный профиль в виде массивов
+  Kernel::Extrema extrema;  ///< Экстремумы просветов и тип интервала
 };
 
 }  // namespace Profile
@@ -246,7 +301,6 @@ struct Data {
  */
 struct Data {
   typedef QSharedPointer<Data> Ptr;
-  typedef QWeakPointer<Data> WeakPtr;
 
   Const::Data constant;  ///< Константы
   Profile::Data param;  ///< Параметры высотного профиля
@@ -262,32 +316,42 @@ struct Data {
   QString filename;
   int interval_type;  ///< Тип интервала: 1-Открытый, 2-Полуоткрытый,
                       ///< 3-Закрытый
+  QVector<Kernel::Zone> zones;  ///< Дополнительные зоны для проверки
+                                ///< просвета
+  Kernel::Clearance clearance;  ///< Просветы и типы интервала по зонам
+  Coarse::Pyramid pyramid;  ///< Прореженный профиль для Core::coarse,
+                            ///< сбрасывается при смене профиля и градиента
+  Kernel::Track scratch;  ///< Рабочий профиль точного расчета Core::coarse,
+                          ///< заполняется вместе с pyramid
   double wp = 0;  ///< Затухания в рельефе
+  QVector<Kernel::Reflection> reflections;  ///< Точки отражения на открытом
+                                            ///< интервале
+  Diffraction::Options diffraction;  ///< Параметры расчета дифракции на
+                                     ///< закрытом интервале
+  QVector<Diffraction::Edge> edges;  ///< Препятствия, учтенные на закрытом
+                                     ///< интервале
   double ws = 0;  ///< Затухания в свободном пространстве
   double wa = 0;  ///< Затухания в газах атмосферы
+  double wr = 0;  ///< Затухание в дожде, превышаемое (100 - prob)% времени
+  QVector<double> wr_p;  ///< Затухания в дожде для constant.rain_percentages
+  double stock = 0;  ///< Требуемый запас связи
   QPair<double, double> p = {0, 0};  ///< Медианное значение сигнала на входе
                                      ///< приёмника
   QPair<double, double> log_p = {0,
                                  0};  ///< Медианное значение сигнала на входе
                                       ///< приёмника в логарифмическом виде
+  int changed = Input::All;  ///< Параметры, измененные с последнего расчета
 };
 
 /**
- * Составляющая расчета. Базовый класс
+ * Составляющая расчета. Базовый класс. Составляющие создаются на стеке над
+ * данными расчета и связываются в цепочку через Pipeline, поэтому каждая
+ * объявляет функции bool exec() и static int inputs() с набором флагов
+ * Input::Flag входных параметров, от которых она зависит
  */
 class Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : _data(data) {}
-
-  virtual ~Item() {}
-
- public:
-  /**
-   * Запуск расчета
-   * @return Признак завершения расчета
-   */
-  virtual bool exec() = 0;
+  explicit Item(Data &data) : data(&data) {}
 
  protected:
   /**
@@ -297,14 +361,6 @@ class Item {
    */
   double k(double R) const;
 
-  /**
-   * Функция вычисления протяженности участка отражения
-   * @param h0 - относительный просвет в точке
-   * @param k - относительная координата
-   * @return Длина участка отражения
-   */
-  double lNull(double h0, double k) const;
-
   /**
    * Функция вычисления критического просвета
    * @param i - индекс точки, в которой считается критический просвет
@@ -333,37 +389,20 @@ class Item {
                                         double yy) const;
 
  protected:
-  Data::WeakPtr _data;
-};
-
-namespace Master {
-
-/**
- * Составляющая расчета, с вложениями
- */
-class Item : public Calc::Item {
- public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data) : Calc::Item(data) {}
-
- protected:
-  QList<Calc::Item::Ptr> _items;
+  Data *const data;
 };
 
-}  // namespace Master
-
 namespace Main {
 
 /**
  * Составляющая расчета. Головной расчет
  */
-class Item : public Master::Item {
+class Item : public Calc::Item {
  public:
-  QSHDEF(Item);
-  Item(const Data::WeakPtr &data);
+  explicit Item(Data &data) : Calc::Item(data) {}
 
  public:
-  virtual bool exec();
+  bool exec();
 };
 
 }  // namespace Main
@@ -376,14 +415,29 @@ class Core {
   virtual bool exec();
   void setFreq(double f);
 
+  /**
+   * Задание дополнительных зон для проверки просвета, например для второй
+   * полосы двухчастотного интервала. Результат - data->clearance
+   * @param zones   - пары частота - доля зоны Френеля
+   */
+  void setZones(const QVector<Kernel::Zone> &zones);
+
+  /**
+   * Пометка входных параметров как измененных
+   * @param input   - набор флагов Input::Flag
+   */
+  void invalidate(int input);
+
   template <typename T = double>
-  void setValue(double &to, double v) {
+  void setValue(double &to, double v, int input = Input::All) {
     to = v;
+    invalidate(input);
   };
 
   template <typename T = double>
-  T setValueWithReturn(T &to, T v) {
+  T setValueWithReturn(T &to, T v, int input = Input::All) {
     to = v;
+    invalidate(input);
     return v;
   };
 
@@ -393,12 +447,159 @@ class Core {
   double xRange();
   double yRange();
 
+  /**
+   * Почасовой расчет запаса связи по метеоданным из файла. Параметры, не
+   * зависящие от погоды, берутся из последнего расчета
+   * @param filename  - имя файла метеоданных
+   * @param r         - запас связи по часам и статистика перерывов
+   * @return Признак успешного расчета
+   */
+  bool series(const QString &filename, Series::Result &r);
+
+  /**
+   * Статистические испытания с ошибками высот рельефа. Градиент и
+   * параметры, не зависящие от ошибок, берутся из последнего расчета
+   * @param o       - модель ошибок и параметры испытаний
+   * @param r       - распределение запаса связи
+   * @return Признак успешного расчета
+   */
+  bool monteCarlo(MonteCarlo::Options o, MonteCarlo::Result &r);
+
+  /**
+   * Чувствительность запаса связи к входным параметрам за один проход.
+   * Тип интервала, точки отражения и препятствия берутся из последнего
+   * расчета
+   * @param r       - затухания, уровни и запас связи с производными по
+   *                  параметрам Budget::Param
+   * @return Признак успешного расчета
+   */
+  bool sensitivity(Budget::Outputs<Budget::Dual> &r);
+
+  /**
+   * Границы затуханий, уровней и запаса связи за один проход интервальной
+   * арифметикой (см. Budget::bounds). Каждый параметр задается отрезком
+   * [значение - отклонение, значение + отклонение] около текущего значения.
+   * Требуемый запас и затухание в дожде, как в Acceptable::Item, тоже
+   * зависят от частоты и оцениваются по всему ее интервалу. Интервал
+   * заведомо годен, если excess.lo() >= 0, и заведомо негоден, если
+   * excess.hi() < 0, только при условии stable
+   * @param spread  - отклонения параметров, 0 - параметр точно известен
+   * @param r       - границы результата
+   * @param excess  - границы запаса связи сверх требуемого с учетом дождя
+   * @param stable  - признак того, что тип интервала и дискретные решения
+   *                  последнего расчета подтверждены и границы гарантированы
+   * @return Признак успешного расчета
+   */
+  bool bounds(const Budget::Inputs<double> &spread,
+              Budget::Outputs<IA::Interval> &r, IA::Interval &excess,
+              bool &stable);
+
+  /**
+   * Расчет запаса связи и типа интервала в полосе частот за один вызов.
+   * Профиль рассчитывается один раз, параметры, не зависящие от частоты,
+   * берутся из последнего расчета
+   * @param f       - частоты (в МГц), например Band::grid(60, 645, 1)
+   * @param r       - затухания, запасы и типы интервала по частотам
+   * @return Признак успешного расчета
+   */
+  bool band(const QVector<double> &f, Band::Result &r);
+
+  /**
+   * Поиск наименьшей пары высот подвеса антенн. Параметры, не зависящие от
+   * высот, берутся из последнего расчета
+   * @param o       - условие и параметры поиска
+   * @param r       - пара высот и наименьшие высоты второй антенны
+   * @return Признак успешного расчета
+   */
+  bool heights(const Heights::Options &o, Heights::Result &r);
+
+  /**
+   * Карта типа интервала и запаса связи по парам высот подвеса антенн на
+   * текущей частоте. Параметры, не зависящие от высот, берутся из последнего
+   * расчета
+   * @param o       - сетка высот и параметры карты
+   * @param r       - карта
+   * @return Признак успешного расчета
+   */
+  bool heightMap(const HeightMap::Options &o, HeightMap::Result &r);
+
+  /**
+   * Быстрая оценка типа интервала и затухания в рельефе по прореженному
+   * профилю. ЛПВ строится по текущим высотам антенн, поэтому расчет можно
+   * вызывать при каждом их изменении без перерасчета профиля; прореженный
+   * профиль строится при первом вызове. Затухание на закрытом интервале
+   * оценивается методом основного расчета. Если границы затухания шире
+   * o.tolerance, затухание рассчитывается точно по полному профилю, и
+   * границы сводятся к точке. Так всегда происходит при методе
+   * Epstein-Peterson и обычно на открытом интервале, где границы охватывают
+   * весь диапазон интерференции: такие интервалы не ускоряются
+   * @param o       - параметры расчета, o.phi и o.diffraction берутся из
+   *                  текущих данных
+   * @param r       - тип интервала и границы просветов и затухания
+   * @return Признак успешного расчета
+   */
+  bool coarse(const Coarse::Options &o, Coarse::Result &r);
+
+  /**
+   * Обратный энергетический расчет по последнему расчету: наименьшая
+   * мощность передатчиков, наибольшие потери в фидерах и затухание в
+   * рельефе, при которых запас связи равен требуемому для spec.prob, и
+   * наибольшая вероятность связи при текущих параметрах
+   * @param r       - результат
+   * @return Признак успешного расчета
+   */
+  bool inverse(Inverse::Result &r);
+
+  /**
+   * Просветы и тип интервала относительно луча, трассированного по
+   * слоистому профилю индекса преломления между текущими антеннами. Для
+   * волноводов и приподнятых слоев заменяет ЛПВ над Землей эквивалентного
+   * радиуса
+   * @param levels  - профиль индекса преломления, пустой - постоянный
+   *                  градиент constant.g_standard
+   * @param t       - высоты луча (los), просветы и зона Френеля
+   * @param e       - экстремумы просветов и тип интервала
+   * @return Признак успешного расчета
+   */
+  bool refraction(const QVector<Refraction::Level> &levels, Kernel::Track &t,
+                  Kernel::Extrema &e);
+
+  /**
+   * Текущий интервал как звено цепочки Chain::Route: профиль, частота,
+   * параметры дождя и станции на его концах
+   * @param first   - первая станция
+   * @param second  - вторая станция
+   * @param h       - интервал
+   * @return Признак успешного расчета
+   */
+  bool hop(Chain::Site &first, Chain::Site &second, Chain::Hop &h) const;
+
+ private:
+  /**
+   * Параметры интервала, не зависящие от погоды и ошибок рельефа
+   */
+  Series::Link _link() const;
+
+  /**
+   * Профиль и дискретные решения последнего расчета
+   */
+  Budget::Path _path() const;
+
+  /**
+   * Входные параметры энергетического расчета из текущих данных
+   */
+  Budget::Inputs<double> _inputs() const;
+
+  /**
+   * Параметры интервала, не зависящие от частоты и высот антенн
+   */
+  Band::Link _band() const;
+
  public:
   Data::Ptr data;
 
  private:
   QCustomPlot *_cp;
-  Main::Item::Ptr _main;
 };
 
 }  // namespace Calc
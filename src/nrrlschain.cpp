@@ -0,0 +1,162 @@
+#include "nrrlschain.h"
+
+#include <thread>
+
+namespace NRrls {
+namespace Calc {
+namespace Chain {
+
+Route::Route(const Options &o, const Stock::Table &stocks)
+    : _o(o), _stocks(stocks) {}
+
+bool Route::set(const QVector<Site> &sites, const QVector<Hop> &hops) {
+  if (sites.size() != hops.size() + 1) return false;
+  _sites = sites;
+  _hops = hops;
+  _dirty.fill(true, hops.size());
+  _r = Result();
+  _r.hops.resize(hops.size());
+  return true;
+}
+
+void Route::setSite(int i, const Site &s) {
+  if (i < 0 || i >= _sites.size()) return;
+  _sites[i] = s;
+  if (i > 0) _dirty[i - 1] = true;
+  if (i < _hops.size()) _dirty[i] = true;
+}
+
+void Route::setHop(int i, const Hop &h) {
+  if (i < 0 || i >= _hops.size()) return;
+  _hops[i] = h;
+  _dirty[i] = true;
+}
+
+void Route::setOptions(const Options &o) {
+  _o = o;
+  _dirty.fill(true, _hops.size());
+}
+
+const Result &Route::evaluate() {
+  QVector<int> dirty;
+  for (int i = 0; i < _hops.size(); ++i)
+    if (_dirty[i]) dirty.push_back(i);
+  const int m = dirty.size();
+  _r.updated = m;
+
+  if (m) {
+    int threads = _o.threads > 0 ? _o.threads
+                                 : static_cast<int>(
+                                       std::thread::hardware_concurrency());
+    threads = qBound(1, threads, m);
+
+    // Массив отделяется до запуска потоков, если результат был скопирован
+    Link *out = _r.hops.data();
+    auto body = [&](int w) {
+      for (int k = m * w / threads; k < m * (w + 1) / threads; ++k)
+        out[dirty[k]] = _hop(dirty[k]);
+    };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; ++w) pool.emplace_back(body, w);
+    body(0);
+    for (auto &th : pool) th.join();
+
+    // SESR пересчитанных интервалов одним пакетом
+    Outage::Links links;
+    for (int i : dirty) {
+      const Hop &h = _hops[i];
+      links.f.push_back(h.f / 1000.0);
+      links.length.push_back(
+          h.track.size() < 2 ? 0
+                             : (h.track.x.last() - h.track.x.first()) / 1000);
+      links.height.push_back((_sites[i].height + _sites[i + 1].height) / 2);
+      links.margin.push_back(_r.hops[i].q);
+      links.rate.push_back(h.rain_rate);
+      links.tau.push_back(h.polarization);
+    }
+    const Outage::Result o = Outage::evaluate(links);
+    for (int k = 0; k < m; ++k) {
+      Link &l = _r.hops[dirty[k]];
+      l.sesrg = o.sesrg[k];
+      l.sesrc = o.sesrc[k];
+      l.sesr = o.sesr[k];
+      _dirty[dirty[k]] = false;
+    }
+  }
+
+  // Показатели из конца в конец
+  double prob = 1;
+  _r.sesr = 0;
+  _r.weakest = -1;
+  for (int i = 0; i < _r.hops.size(); ++i) {
+    const Link &l = _r.hops[i];
+    prob *= l.prob / 100;
+    _r.sesr += l.sesr;
+    if (_r.weakest < 0) {
+      _r.weakest = i;
+      continue;
+    }
+    const Link &w = _r.hops[_r.weakest];
+    if (l.prob < w.prob ||
+        (l.prob == w.prob && l.q - l.stock < w.q - w.stock))
+      _r.weakest = i;
+  }
+  _r.prob = _r.hops.isEmpty() ? 0 : prob * 100;
+  return _r;
+}
+
+Link Route::_hop(int i) const {
+  Link res;
+  const Hop &h = _hops[i];
+  const Site &a = _sites[i], &b = _sites[i + 1];
+  if (h.track.size() < 2 || h.f <= 0) return res;
+
+  Inverse::Link il;
+  il.p = {a.power, b.power};
+  il.c = {a.gain, b.gain};
+  il.wf = {a.feeder, b.feeder};
+  il.s = qAbs(a.sensitivity) > qAbs(b.sensitivity) ? a.sensitivity
+                                                   : b.sensitivity;
+
+  Band::Link l;
+  const double x0 = h.track.x.first(), xn = h.track.x.last();
+  l.params.area_length = xn - x0;
+  l.params.equivalent_radius = Kernel::equivalentRadius(_o.radius, _o.g);
+  l.track = h.track;
+  l.tx = {x0, h.track.y.first() + a.height};
+  l.rx = {xn, h.track.y.last() + b.height};
+  const double s = (l.rx.y - l.tx.y) / (xn - x0);
+  l.params.los = {s, l.tx.y - s * x0};
+  l.diffraction = _o.diffraction;
+  l.atmosphere = _o.atmosphere;
+  l.reflection_coef = _o.reflection_coef;
+  l.gain = Inverse::margin(il);
+  l.rain_rate = h.rain_rate;
+  l.polarization = h.polarization;
+  l.percent = 100 - _o.prob;
+
+  const Band::Result r =
+      Band::evaluate(l, {h.f}, {_stocks(h.f, 100 - _o.prob)});
+  res.type = r.type.first();
+  res.ws = r.ws.first();
+  res.wa = r.wa.first();
+  res.wp = r.wp.first();
+  res.wr = r.wr.first();
+  res.q = r.q.first();
+  res.stock = r.stock.first();
+
+  il.ws = res.ws;
+  il.wa = res.wa;
+  il.wp = res.wp;
+  Atmosphere::Rain::Link rain;
+  rain.f = h.f / 1000.0;
+  rain.length = l.params.area_length / 1000.0;
+  rain.rate = h.rain_rate;
+  rain.tau = h.polarization;
+  res.prob = Inverse::maxProb(il, Inverse::Required(_stocks, h.f, rain));
+  return res;
+}
+
+}  // namespace Chain
+}  // namespace Calc
+}  // namespace NRrls
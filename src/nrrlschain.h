@@ -0,0 +1,146 @@
+#ifndef NRRLSCHAIN_H
+#define NRRLSCHAIN_H
+
+#include "nrrlsband.h"
+#include "nrrlsinverse.h"
+#include "nrrlsoutage.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Chain {
+
+/**
+ * Станция цепочки. Параметры одинаковы для антенн в сторону обоих соседних
+ * интервалов
+ */
+struct Site {
+  double height = 0;  ///< Высота подвеса антенн (в метрах)
+  double power = 0;   ///< Мощность передатчиков (в Вт)
+  double gain = 0;    ///< КУ антенн (в дБ)
+  double feeder = 0;  ///< Потери в фидерах (в дБ)
+  double sensitivity = 0;  ///< Чувствительность приемников (в дБ
+                           ///< относительно 1 мкВ)
+};
+
+/**
+ * Интервал между соседними станциями
+ */
+struct Hop {
+  Kernel::Track track;  ///< Профиль от станции i к станции i + 1, массивы x
+                        ///< и y должны быть заполнены
+  double f = 0;         ///< Частота (в МГц)
+  double rain_rate = 0;  ///< Интенсивность дождя, превышаемая 0,01% времени
+                         ///< (в мм/ч)
+  double polarization = 0;  ///< Угол наклона поляризации (в градусах)
+};
+
+/**
+ * Параметры, общие для всех интервалов
+ */
+struct Options {
+  double radius = 6.37e+06;  ///< Радиус Земли (в метрах)
+  double g = 0;              ///< Градиент индекса преломления (в 1/м)
+  double prob = 99.9;        ///< Вероятность связи на интервале (в %)
+  Diffraction::Options diffraction;
+  Atmosphere::Conditions atmosphere;
+  QMap<double, QVector<double>> reflection_coef;  ///< Коэффициенты отражения
+                                                  ///< по длинам волн
+  int threads = 0;  ///< Число потоков, 0 - по числу ядер
+};
+
+/**
+ * Результат расчета интервала
+ */
+struct Link {
+  int type = 0;  ///< Тип интервала: 1-Открытый, 2-Полуоткрытый, 3-Закрытый
+  double ws = 0;     ///< Затухание в свободном пространстве
+  double wa = 0;     ///< Затухание в газах атмосферы
+  double wp = 0;     ///< Затухание в рельефе
+  double wr = 0;     ///< Затухание в дожде
+  double q = 0;      ///< Запас связи
+  double stock = 0;  ///< Требуемый запас связи с учетом дождя
+  double prob = 0;   ///< Наибольшая вероятность связи (в %)
+  double sesrg = 0;  ///< SESR из-за интерференционных замираний (доля
+                     ///< времени)
+  double sesrc = 0;  ///< SESR из-за дождя (доля времени)
+  double sesr = 0;   ///< Суммарный SESR (доля времени)
+};
+
+/**
+ * Результат расчета цепочки
+ */
+struct Result {
+  QVector<Link> hops;  ///< Результаты по интервалам
+  double prob = 0;     ///< Вероятность связи из конца в конец (в %)
+  double sesr = 0;     ///< SESR из конца в конец (доля времени)
+  int weakest = -1;    ///< Номер интервала с наименьшей вероятностью связи,
+                       ///< при равных - с наименьшим избытком запаса
+  int updated = 0;     ///< Число интервалов, пересчитанных последним вызовом
+};
+
+/**
+ * Цепочка интервалов. Интервалы рассчитываются независимо друг от друга,
+ * поэтому считаются параллельно, а результат каждого хранится до изменения
+ * его станций или профиля: изменение станции помечает только два смежных
+ * интервала. Показатели из конца в конец собираются по всем интервалам:
+ * вероятности связи перемножаются, SESR складываются
+ */
+class Route {
+ public:
+  /**
+   * @param o       - параметры, общие для всех интервалов
+   * @param stocks  - таблица требуемых запасов, должна существовать, пока
+   *                  существует цепочка
+   */
+  Route(const Options &o, const Stock::Table &stocks);
+
+  /**
+   * Задание цепочки, все интервалы помечаются измененными
+   * @param sites   - станции по порядку
+   * @param hops    - интервалы, hops.size() == sites.size() - 1
+   * @return Признак согласованности станций и интервалов
+   */
+  bool set(const QVector<Site> &sites, const QVector<Hop> &hops);
+
+  /**
+   * Изменение параметров станции i
+   */
+  void setSite(int i, const Site &s);
+
+  /**
+   * Изменение интервала i
+   */
+  void setHop(int i, const Hop &h);
+
+  /**
+   * Изменение общих параметров, все интервалы помечаются измененными
+   */
+  void setOptions(const Options &o);
+
+  int size() const { return _hops.size(); }
+
+  /**
+   * Расчет измененных интервалов и показателей из конца в конец
+   * @return Результат по всей цепочке
+   */
+  const Result &evaluate();
+
+ private:
+  /**
+   * Расчет интервала i по текущим станциям
+   */
+  Link _hop(int i) const;
+
+  Options _o;
+  const Stock::Table &_stocks;
+  QVector<Site> _sites;
+  QVector<Hop> _hops;
+  QVector<bool> _dirty;  ///< Интервалы, измененные с последнего расчета
+  Result _r;
+};
+
+}  // namespace Chain
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSCHAIN_H
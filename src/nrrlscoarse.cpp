@@ -0,0 +1,453 @@
+#include "nrrlscoarse.h"
+
+#include "nrrlsbudget.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Coarse {
+
+namespace {
+
+/**
+ * Блок пирамиды с границами просветов. Нижняя граница минимума находится
+ * по наибольшей высоте и наименьшей высоте ЛПВ в блоке, верхняя - значение
+ * в точке наибольшей высоты
+ */
+struct Node {
+  int level;
+  int j;
+  int begin;  ///< Первая точка блока
+  int end;    ///< Последняя точка блока
+  double hi;  ///< Наибольшая высота
+  double lo;  ///< Наименьшая высота
+  int arg;    ///< Точка с наибольшей высотой
+  IA::Interval H;  ///< Границы минимального просвета в блоке
+  IA::Interval M;  ///< Границы минимальной разности H - H_null в блоке
+};
+
+/**
+ * Затухание на эквивалентном препятствии Bullington по наклонам
+ * касательных из концов
+ */
+IA::Interval bullington(const IA::Interval &s_a, const IA::Interval &s_b,
+                        double x0, double ya, double xn, double yb,
+                        double lambda) {
+  return Diffraction::atten(Diffraction::bullingtonParam<IA::Interval>(
+      s_a, s_b, {x0, ya}, ya, {xn, yb}, yb, lambda));
+}
+
+/**
+ * Наибольшее число участков, просматриваемых при построении оболочки
+ * Deygout
+ */
+const int deygout_budget = 4096;
+
+/**
+ * Число уровней, на которое уточняются блоки оболочки Deygout за один
+ * проход: главное препятствие части участка обычно лежит рядом с его
+ * концом, и блок приходится уточнять до отдельных точек
+ */
+const int deygout_levels = 3;
+
+/**
+ * Оболочка затухания Deygout по блокам прореженного профиля, как
+ * Budget::bounds по точкам. Главным на участке может стать любой блок,
+ * верхняя граница параметра дифракции которого не меньше наибольшей нижней
+ * границы. Для блока из одной точки затухание на ней складывается с
+ * оболочками частей слева и справа; части блока из нескольких точек не
+ * оцениваются, и блок отмечается для уточнения
+ */
+class DeygoutHull {
+ public:
+  /**
+   * @param x       - расстояния точек профиля
+   * @param ye      - высоты точек профиля с учетом земной поверхности
+   * @param nodes   - блоки, покрывающие профиль по порядку
+   * @param lambda  - длина волны
+   */
+  DeygoutHull(const QVector<double> &x, const QVector<double> &ye,
+              const QVector<Node> &nodes, double lambda)
+      : split(x.size(), false),
+        _x(x),
+        _ye(ye),
+        _nodes(nodes),
+        _lambda(lambda) {}
+
+  /**
+   * Построение оболочки между антеннами
+   * @param a       - высота первой антенны
+   * @param b       - высота второй антенны
+   * @param depth   - глубина рекурсии
+   * @param wp      - оболочка затухания
+   * @return Признак того, что оболочка построена
+   */
+  bool exec(double a, double b, int depth, IA::Interval &wp) {
+    const int n = _x.size();
+    return _hull({0, _x[0], a}, {n - 1, _x[n - 1], b}, depth, wp);
+  }
+
+  QVector<bool> split;  ///< Блоки для уточнения по первой точке
+
+ private:
+  struct End {
+    int idx;
+    double x;
+    double y;
+  };
+
+  /**
+   * Границы параметра дифракции точек блока e между концами a и b: по
+   * наибольшей и наименьшей высоте блока, нижняя граница уточняется
+   * значением в точке наибольшей высоты
+   * @return Признак того, что в блоке есть точки между концами
+   */
+  bool _param(const Node &e, const End &a, const End &b, int &ib, int &ie,
+              IA::Interval &v) const {
+    ib = qMax(e.begin, a.idx + 1);
+    ie = qMin(e.end, b.idx - 1);
+    if (ib > ie) return false;
+
+    // Те же выражения, что и в Diffraction::loss
+    const double d = b.x - a.x, s = (b.y - a.y) / d;
+    auto line = [&](double x) { return a.y + s * (x - a.x); };
+    auto exact = [&](int i) {
+      return Diffraction::param(_ye[i] - line(_x[i]), _x[i] - a.x,
+                                a.x + d - _x[i], _lambda);
+    };
+    if (ib == ie) {
+      v = exact(ib);
+      return true;
+    }
+
+    // Произведение d1 * d2 максимально в середине участка
+    const double xb = _x[ib], xe = _x[ie], xm = a.x + d / 2;
+    const double pb = (xb - a.x) * (b.x - xb), pe = (xe - a.x) * (b.x - xe);
+    const double p_max = xb <= xm && xm <= xe ? d * d / 4 : qMax(pb, pe);
+    const IA::Interval h(e.lo - qMax(line(xb), line(xe)),
+                         e.hi - qMin(line(xb), line(xe)));
+    v = h * IA::Interval(qSqrt(2 * d / (_lambda * p_max)),
+                         qSqrt(2 * d / (_lambda * qMin(pb, pe))));
+    if (e.arg >= ib && e.arg <= ie)
+      v = IA::Interval(qMax(v.lo(), exact(e.arg)), v.hi());
+    return true;
+  }
+
+  bool _hull(const End &a, const End &b, int depth, IA::Interval &wp) {
+    wp = 0;
+    if (depth <= 0 || b.idx - a.idx < 2) return true;
+    if (--_budget < 0) return false;
+
+    // Блоки, пересекающие участок
+    auto first = std::lower_bound(
+        _nodes.begin(), _nodes.end(), a.idx,
+        [](const Node &e, int i) { return e.end <= i; });
+    const int size = _nodes.end() - first;
+    QVector<const Node *> e;
+    QVector<IA::Interval> v;
+    QVector<QPair<int, int>> range;
+    e.reserve(size);
+    v.reserve(size);
+    range.reserve(size);
+    double v_lo = -HUGE_VAL;
+    for (auto it = first; it != _nodes.end() && it->begin < b.idx; ++it) {
+      int ib, ie;
+      IA::Interval v_i;
+      if (!_param(*it, a, b, ib, ie, v_i)) continue;
+      e.push_back(&*it);
+      v.push_back(v_i);
+      range.push_back({ib, ie});
+      v_lo = qMax(v_lo, v_i.lo());
+    }
+    if (e.isEmpty()) return true;
+
+    // Допуск покрывает расхождение высот пирамиды и профиля в младших
+    // разрядах
+    auto candidate = [&](int k) { return v[k].hi() >= v_lo - 1e-9; };
+
+    // Пока главным может оказаться блок из нескольких точек, верхняя граница
+    // бесконечна, и части участка оцениваются после его уточнения
+    bool blocks = false;
+    for (int k = 0; k < e.size(); ++k) {
+      if (!candidate(k) || range[k].first == range[k].second) continue;
+      std::fill(split.begin() + e[k]->begin, split.begin() + e[k]->end + 1,
+                true);
+      blocks = true;
+    }
+
+    double lo = HUGE_VAL, hi = -HUGE_VAL;
+    for (int k = 0; k < e.size(); ++k) {
+      if (!candidate(k)) continue;
+
+      const int ib = range[k].first, ie = range[k].second;
+      IA::Interval w = Diffraction::atten(v[k]);
+      if (w.hi() > 0 && depth > 1) {
+        if (ib == ie && !blocks) {
+          const End m = {ib, _x[ib], _ye[ib]};
+          IA::Interval left, right;
+          if (!_hull(a, m, depth - 1, left) || !_hull(m, b, depth - 1, right))
+            return false;
+          w += left + right;
+        } else {
+          w += IA::Interval(0, HUGE_VAL);
+        }
+      }
+      lo = qMin(lo, Diffraction::atten(v[k].lo()) > 0 ? w.lo() : 0.0);
+      hi = qMax(hi, w.hi());
+    }
+    wp = IA::Interval(lo, hi);
+    return true;
+  }
+
+  const QVector<double> &_x, &_ye;
+  const QVector<Node> &_nodes;
+  double _lambda;
+  int _budget = deygout_budget;
+};
+
+}  // namespace
+
+Pyramid::Pyramid(const Kernel::Params &p, const Kernel::Track &t)
+    : _x(t.x) {
+  const int n = t.size();
+  if (!n) return;
+
+  // Высоты профиля с учетом земной поверхности, как в Kernel::profilePass
+  const double x0 = t.x.first(), half = p.area_length / 2,
+               inv_2r = 1 / (2 * p.equivalent_radius);
+  Level base;
+  base.hi.resize(n);
+  for (int i = 0; i < n; ++i) {
+    const double m = t.x[i] - x0 - half;
+    base.hi[i] = t.y[i] + (half * half - m * m) * inv_2r;
+  }
+  _levels.push_back(base);
+
+  // Блок следующего уровня объединяет два соседних блока
+  for (int k = 0, size = n; size > 1; ++k) {
+    const int m = (size + 1) / 2;
+    Level next;
+    next.hi.resize(m);
+    next.lo.resize(m);
+    next.arg.resize(m);
+    for (int j = 0; j < m; ++j) {
+      const int l = 2 * j, r = qMin(2 * j + 1, size - 1);
+      const bool right = _hi(k, r) > _hi(k, l);
+      next.hi[j] = right ? _hi(k, r) : _hi(k, l);
+      next.arg[j] = right ? _arg(k, r) : _arg(k, l);
+      next.lo[j] = qMin(_lo(k, l), _lo(k, r));
+    }
+    _levels.push_back(next);
+    size = m;
+  }
+}
+
+Result Pyramid::evaluate(const Kernel::Params &p, const Options &o) const {
+  Result res;
+  const int n = _x.size();
+  if (!n) return res;
+
+  const double x0 = _x.first(), xn = _x.last();
+  const double inv_l = 1 / p.area_length, zone = p.area_length * p.lambda / 3;
+  const double a = p.los.first, b = p.los.second;
+  const double y0 = _hi(0, 0), yn = _hi(0, n - 1);
+  const double ya = a * x0 + b, yb = a * xn + b;
+
+  auto hNull = [&](double x) {
+    const double k = (x - x0) * inv_l;
+    return qSqrt(qMax(zone * k * (1 - k), 0.0));
+  };
+
+  auto node = [&](int k, int j) {
+    ++res.nodes;
+    Node e;
+    e.level = k;
+    e.j = j;
+    e.begin = j << k;
+    e.end = qMin((j + 1) << k, n) - 1;
+    e.hi = _hi(k, j);
+    e.lo = _lo(k, j);
+    e.arg = _arg(k, j);
+
+    const double H = a * _x[e.arg] + b - e.hi;
+    const double M = H - (e.arg == n - 1 ? 0 : hNull(_x[e.arg]));
+    if (!k) {
+      e.H = H;
+      e.M = M;
+      return e;
+    }
+    // Критический просвет наибольший в середине интервала
+    const double xb = _x[e.begin], xe = _x[e.end];
+    const double low = qMin(a * xb + b, a * xe + b) - e.hi;
+    e.H = IA::Interval(qMin(low, H), H);
+    e.M = IA::Interval(
+        qMin(low - hNull(qBound(xb, x0 + p.area_length / 2, xe)), M), M);
+    return e;
+  };
+
+  int start = 0;
+  while (start + 1 < _levels.size() && (2 << start) <= o.block) ++start;
+  QVector<Node> active;
+  const int top = start ? _levels[start].hi.size() : n;
+  active.reserve(top);
+  for (int j = 0; j < top; ++j) active.push_back(node(start, j));
+
+  // Замена блоков, удовлетворяющих условию, блоками следующего уровня
+  auto refine = [&](const std::function<bool(const Node &)> &f) {
+    QVector<Node> next;
+    next.reserve(active.size());
+    bool split = false;
+    for (const Node &e : active) {
+      if (!e.level || !f(e)) {
+        next.push_back(e);
+        continue;
+      }
+      split = true;
+      const int j = 2 * e.j;
+      next.push_back(node(e.level - 1, j));
+      if ((j + 1) << (e.level - 1) < n)
+        next.push_back(node(e.level - 1, j + 1));
+    }
+    active.swap(next);
+    return split;
+  };
+
+  // Тип интервала: те же условия, что в Kernel::intervalType, проверяются по
+  // границам минимальных просветов
+  while (!res.type) {
+    IA::Interval H = HUGE_VAL, M = HUGE_VAL;
+    for (const Node &e : active) {
+      H = qMin(H, e.H);
+      M = qMin(M, e.M);
+    }
+    res.min_H = H;
+    res.min_H_margin = M;
+
+    bool split = true;
+    if (H.hi() < 0)
+      res.type = 3;
+    else if (H.lo() < 0)
+      split = refine([](const Node &e) { return e.H.lo() < 0; });
+    else if (M.lo() >= 0)
+      res.type = 1;
+    else if (M.hi() >= 0)
+      split = refine([](const Node &e) { return e.M.lo() < 0; });
+    else if (H.lo() > 0)
+      res.type = 2;
+    else
+      split = refine([](const Node &e) { return e.H.lo() <= 0; });
+    if (split || res.type) continue;
+
+    // Минимальный просвет точно равен нулю: тип решает первая точка с
+    // просветом меньше критического
+    bool opened = false;
+    for (int i = 0; i < n && !res.type; ++i) {
+      const double h = a * _x[i] + b - _hi(0, i);
+      const double h_null = i == n - 1 ? 0 : hNull(_x[i]);
+      if (h > 0 && h < h_null) res.type = 2;
+      opened = opened || h >= h_null;
+    }
+    if (!res.type) res.type = opened ? 1 : 0;
+    break;
+  }
+
+  switch (res.type) {
+    case 1: {
+      // Интерференционное затухание при любом просвете в точке отражения;
+      // без точек отражения оно нулевое и тоже лежит в этих границах
+      const double phi2 = o.phi * o.phi;
+      res.wp = IA::Interval(-10 * log10(1 + 3 * phi2),
+                            phi2 < 1 ? -10 * log10(1 - phi2) : HUGE_VAL);
+      break;
+    }
+    case 2: {
+      // Препятствие с минимальным просветом лежит в одном из блоков, нижняя
+      // граница которых не превышает верхнюю границу минимума
+      do {
+        IA::Interval x = HUGE_VAL, y = HUGE_VAL, H = HUGE_VAL;
+        for (const Node &e : active) H = qMin(H, e.H);
+        bool first = true;
+        for (const Node &e : active) {
+          if (e.H.lo() > H.hi()) continue;
+          const IA::Interval ex(_x[e.begin], _x[e.end]), ey(e.lo, e.hi);
+          x = first ? ex : IA::Interval(qMin(x.lo(), ex.lo()),
+                                        qMax(x.hi(), ex.hi()));
+          y = first ? ey : IA::Interval(qMin(y.lo(), ey.lo()),
+                                        qMax(y.hi(), ey.hi()));
+          first = false;
+        }
+        res.min_H = H;
+        res.wp = Diffraction::atten(Diffraction::shadingParam<IA::Interval>(
+            -H, x - x0, qAbs(y - y0), xn - x, qAbs(y - yn), p.lambda));
+        if (res.wp.width() <= o.tolerance) break;
+      } while (refine(
+          [&](const Node &e) { return e.H.lo() <= res.min_H.hi(); }));
+      break;
+    }
+    case 3: {
+      if (o.diffraction.method == Diffraction::Method::EpsteinPeterson) {
+        // Препятствия Epstein-Peterson по блокам не оцениваются
+        res.wp = IA::Interval(0, HUGE_VAL);
+        break;
+      }
+      if (o.diffraction.method == Diffraction::Method::Deygout) {
+        bool split = true;
+        while (split) {
+          DeygoutHull h(_x, _levels[0].hi, active, p.lambda);
+          if (!h.exec(ya, yb, o.diffraction.depth, res.wp)) {
+            res.wp = IA::Interval(0, HUGE_VAL);
+            break;
+          }
+          if (res.wp.width() <= o.tolerance) break;
+          split = false;
+          for (int k = 0; k < deygout_levels; ++k)
+            split = refine([&](const Node &e) { return h.split[e.begin]; }) ||
+                    split;
+        }
+        break;
+      }
+
+      // Наклоны касательных из концов: верхняя граница по наибольшей высоте
+      // и ближайшей к концу точке блока, нижняя - по точке наибольшей высоты
+      auto slopes = [&](const Node &e, IA::Interval &sa, IA::Interval &sb) {
+        const int ib = qMax(e.begin, 1), ie = qMin(e.end, n - 2);
+        if (ib > ie) return false;
+        const double na = e.hi - ya, nb = e.hi - yb;
+        const double ua = na / ((na >= 0 ? _x[ib] : _x[ie]) - x0);
+        const double ub = nb / (xn - (nb >= 0 ? _x[ie] : _x[ib]));
+        double la = -HUGE_VAL, lb = -HUGE_VAL;
+        if (e.arg >= 1 && e.arg <= n - 2) {
+          la = na / (_x[e.arg] - x0);
+          lb = nb / (xn - _x[e.arg]);
+        }
+        sa = IA::Interval(qMin(la, ua), ua);
+        sb = IA::Interval(qMin(lb, ub), ub);
+        return true;
+      };
+
+      IA::Interval s_a, s_b;
+      do {
+        s_a = s_b = -HUGE_VAL;
+        IA::Interval sa, sb;
+        for (const Node &e : active) {
+          if (!slopes(e, sa, sb)) continue;
+          s_a = qMax(s_a, sa);
+          s_b = qMax(s_b, sb);
+        }
+        res.wp = s_a + s_b <= 0
+                     ? IA::Interval(0)
+                     : bullington(s_a, s_b, x0, ya, xn, yb, p.lambda);
+        if (res.wp.width() <= o.tolerance) break;
+      } while (refine([&](const Node &e) {
+        IA::Interval sa, sb;
+        return slopes(e, sa, sb) &&
+               (sa.hi() > s_a.lo() || sb.hi() > s_b.lo());
+      }));
+      break;
+    }
+  }
+  return res;
+}
+
+}  // namespace Coarse
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,115 @@
+#ifndef NRRLSCOARSE_H
+#define NRRLSCOARSE_H
+
+#include "nrrlsdiffraction.h"
+#include "nrrlsinterval.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Coarse {
+
+/**
+ * Параметры расчета
+ */
+struct Options {
+  int block = 64;  ///< Число точек в блоке начального уровня
+  double tolerance = .5;  ///< Допустимая ширина границ затухания в рельефе
+                          ///< (в дБ)
+  double phi = 1;  ///< Наибольший коэффициент отражения на открытом
+                   ///< интервале
+  Diffraction::Options diffraction;  ///< Параметры расчета дифракции на
+                                     ///< закрытом интервале
+};
+
+/**
+ * Результат расчета с границами
+ */
+struct Result {
+  int type = 0;  ///< Тип интервала: 1-Открытый, 2-Полуоткрытый, 3-Закрытый
+  IA::Interval min_H;         ///< Границы минимального просвета
+  IA::Interval min_H_margin;  ///< Границы минимальной разности H - H_null
+  IA::Interval wp;            ///< Границы затухания в рельефе
+  int nodes = 0;  ///< Число просмотренных блоков, на точном уровне блок -
+                  ///< одна точка
+};
+
+/**
+ * Прореженный профиль: пирамида наибольших и наименьших высот профиля с
+ * учетом земной поверхности по блокам из 2^k точек. Высоты не зависят от
+ * высот антенн и частоты, поэтому пирамида строится один раз на профиль и
+ * градиент
+ */
+class Pyramid {
+ public:
+  Pyramid() {}
+
+  /**
+   * Построение пирамиды
+   * @param p       - параметры трассы, используются длина интервала и
+   *                  эквивалентный радиус
+   * @param t       - профиль, массивы x и y должны быть заполнены
+   */
+  Pyramid(const Kernel::Params &p, const Kernel::Track &t);
+
+  bool isEmpty() const { return _x.isEmpty(); }
+
+  /**
+   * Функция расчета типа интервала и затухания в рельефе от грубого уровня
+   * к точному. На каждом уровне для блока по наибольшей высоте и крайним
+   * точкам находятся нижние границы просветов, а по точке наибольшей высоты
+   * - их точные значения, которые дают верхние границы. Тип интервала
+   * определяется, как только границы минимальных просветов исключают
+   * остальные типы; иначе уточняются только блоки, нижняя граница которых
+   * не позволяет принять решение. Границы затухания в рельефе на закрытом
+   * интервале находятся методом o.diffraction: для Bullington - по
+   * границам наклонов касательных из концов, для Deygout - оболочкой по
+   * всем блокам, которые могут содержать главное препятствие на каждом
+   * участке; на полуоткрытом - по препятствию с минимальным просветом.
+   * Блоки уточняются, пока ширина границ больше o.tolerance. Для
+   * Epstein-Peterson границы не оцениваются и равны [0, inf). На открытом
+   * интервале точки отражения не ищутся, и границы - весь диапазон
+   * интерференционного затухания при коэффициенте отражения не больше
+   * o.phi
+   * @param p       - параметры трассы: длина волны и ЛПВ
+   * @param o       - параметры расчета
+   * @return Тип интервала и границы
+   */
+  Result evaluate(const Kernel::Params &p, const Options &o = Options()) const;
+
+ private:
+  /**
+   * Уровень пирамиды: блок j объединяет точки [j * 2^k, (j + 1) * 2^k)
+   */
+  struct Level {
+    QVector<double> hi;  ///< Наибольшие высоты
+    QVector<double> lo;  ///< Наименьшие высоты
+    QVector<int> arg;    ///< Индексы точек с наибольшей высотой
+  };
+
+  /**
+   * Наибольшая высота в блоке j уровня k
+   */
+  double _hi(int k, int j) const { return _levels[k].hi[j]; }
+
+  /**
+   * Наименьшая высота в блоке j уровня k
+   */
+  double _lo(int k, int j) const {
+    return k ? _levels[k].lo[j] : _levels[0].hi[j];
+  }
+
+  /**
+   * Индекс точки с наибольшей высотой в блоке j уровня k
+   */
+  int _arg(int k, int j) const { return k ? _levels[k].arg[j] : j; }
+
+  QVector<double> _x;
+  QVector<Level> _levels;  ///< Уровень 0 - точки профиля, хранит только
+                           ///< высоты
+};
+
+}  // namespace Coarse
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSCOARSE_H
@@ -0,0 +1,293 @@
+#include "nrrlsdiffraction.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Diffraction {
+
+namespace {
+
+/**
+ * Конец участка, на котором ищется главное препятствие
+ */
+struct End {
+  int idx;
+  Point p;
+};
+
+/**
+ * Поиск точки с наибольшим параметром дифракции между двумя концами.
+ * Отрезки профиля отсекаются по верхней оценке параметра, полученной из
+ * максимума высоты на отрезке, поэтому обычно просматривается лишь
+ * окрестность главного препятствия
+ */
+class MainEdge {
+ public:
+  MainEdge(const Kernel::Track &t, const Kernel::RangeMax &rmq, double lambda,
+           const End &a, const End &b)
+      : _x(t.x.constData()),
+        _y(t.ye.constData()),
+        _rmq(rmq),
+        _lambda(lambda),
+        _a(a.p),
+        _d(b.p.x - a.p.x),
+        _s((b.p.y - a.p.y) / (b.p.x - a.p.x)) {
+    _visit(a.idx + 1, b.idx - 1);
+  }
+
+  int idx() const { return _best; }
+  double v() const { return _best_v; }
+
+ private:
+  double _line(int i) const { return _a.y + _s * (_x[i] - _a.x); }
+
+  double _d1d2(int i) const { return (_x[i] - _a.x) * (_a.x + _d - _x[i]); }
+
+  double _v(int i) const {
+    return param(_y[i] - _line(i), _x[i] - _a.x, _a.x + _d - _x[i], _lambda);
+  }
+
+  /**
+   * Верхняя оценка параметра дифракции на отрезке [l, r]
+   */
+  double _bound(int l, int r) const {
+    const double h = _y[_rmq.query(l, r)] - qMin(_line(l), _line(r));
+    const double pl = _d1d2(l), pr = _d1d2(r);
+    if (h >= 0) return h * qSqrt(2 * _d / (_lambda * qMin(pl, pr)));
+
+    // Произведение d1 * d2 максимально в середине интервала
+    const double xm = _a.x + _d / 2;
+    const double p_max =
+        (_x[l] <= xm && xm <= _x[r]) ? _d * _d / 4 : qMax(pl, pr);
+    return h * qSqrt(2 * _d / (_lambda * p_max));
+  }
+
+  void _visit(int l, int r) {
+    if (l > r) return;
+    if (_best >= 0 && _bound(l, r) <= _best_v) return;
+
+    if (r - l < 16) {
+      for (int i = l; i <= r; ++i) {
+        const double v = _v(i);
+        if (_best < 0 || v > _best_v) _best_v = v, _best = i;
+      }
+      return;
+    }
+
+    const int m = (l + r) / 2;
+    if (_bound(l, m) >= _bound(m + 1, r)) {
+      _visit(l, m);
+      _visit(m + 1, r);
+    } else {
+      _visit(m + 1, r);
+      _visit(l, m);
+    }
+  }
+
+ private:
+  const double *_x, *_y;
+  const Kernel::RangeMax &_rmq;
+  double _lambda;
+  Point _a;
+  double _d;  ///< Расстояние между концами
+  double _s;  ///< Наклон линии, соединяющей концы
+  int _best = -1;
+  double _best_v = 0;
+};
+
+double deygout(const Kernel::Track &t, const Kernel::RangeMax &rmq,
+               double lambda, const End &a, const End &b, int depth,
+               QVector<Edge> &edges) {
+  if (depth <= 0 || b.idx - a.idx < 2) return 0;
+
+  const MainEdge main(t, rmq, lambda, a, b);
+  const double w = atten(main.v());
+  if (main.idx() < 0 || w <= 0) return 0;
+
+  edges.push_back({main.idx(), main.v(), w});
+  const End m = {main.idx(), {t.x[main.idx()], t.ye[main.idx()]}};
+  return w + deygout(t, rmq, lambda, a, m, depth - 1, edges) +
+         deygout(t, rmq, lambda, m, b, depth - 1, edges);
+}
+
+double epsteinPeterson(const Kernel::Track &t, const Point &a, const Point &b,
+                       double lambda, int depth, QVector<Edge> &edges) {
+  QVector<Kernel::Obstacle> o = Kernel::obstacles(t);
+
+  // Учитываются depth препятствий с наибольшим возвышением над ЛПВ
+  if (depth > 0 && o.size() > depth) {
+    std::nth_element(o.begin(), o.begin() + depth, o.end(),
+                     [&](const Kernel::Obstacle &l, const Kernel::Obstacle &r) {
+                       return t.H[l.top] < t.H[r.top];
+                     });
+    o.resize(depth);
+    std::sort(o.begin(), o.end(),
+              [](const Kernel::Obstacle &l, const Kernel::Obstacle &r) {
+                return l.top < r.top;
+              });
+  }
+
+  double w = 0;
+  for (int k = 0; k < o.size(); ++k) {
+    const Point l = k ? Point{t.x[o[k - 1].top], t.ye[o[k - 1].top]} : a;
+    const Point r =
+        k + 1 < o.size() ? Point{t.x[o[k + 1].top], t.ye[o[k + 1].top]} : b;
+    const int i = o[k].top;
+    const double s = (r.y - l.y) / (r.x - l.x);
+    const double v = param(t.ye[i] - (l.y + s * (t.x[i] - l.x)), t.x[i] - l.x,
+                           r.x - t.x[i], lambda);
+    edges.push_back({i, v, atten(v)});
+    w += edges.last().atten;
+  }
+  return w;
+}
+
+double bullington(const Kernel::Track &t, const Point &a, const Point &b,
+                  double lambda, QVector<Edge> &edges) {
+  const int n = t.size();
+  if (n < 3) return 0;
+
+  // Наибольшие наклоны прямых, проведенных от концов к профилю
+  double s_a = -HUGE_VAL, s_b = -HUGE_VAL;
+  int i_a = 1, i_b = n - 2;
+  for (int i = 1; i < n - 1; ++i) {
+    const double sa = (t.ye[i] - a.y) / (t.x[i] - a.x);
+    const double sb = (t.ye[i] - b.y) / (b.x - t.x[i]);
+    if (sa > s_a) s_a = sa, i_a = i;
+    if (sb > s_b) s_b = sb, i_b = i;
+  }
+  if (s_a + s_b <= 0) return 0;
+
+  const double v = bullingtonParam(s_a, s_b, a, a.y, b, b.y, lambda);
+
+  edges.push_back({t.H[i_a] < t.H[i_b] ? i_a : i_b, v, atten(v)});
+  return edges.last().atten;
+}
+
+/**
+ * Узел дерева препятствий Deygout, построенного без отсечения по затуханию
+ */
+struct Node {
+  double v;   ///< Параметр дифракции при единичной длине волны
+  int left;   ///< Номер узла левой части, -1 - нет
+  int right;  ///< Номер узла правой части, -1 - нет
+};
+
+int deygoutTree(const Kernel::Track &t, const Kernel::RangeMax &rmq,
+                const End &a, const End &b, int depth, QVector<Node> &nodes) {
+  if (depth <= 0 || b.idx - a.idx < 2) return -1;
+
+  const MainEdge main(t, rmq, 1, a, b);
+  if (main.idx() < 0) return -1;
+
+  const int k = nodes.size();
+  nodes.push_back({main.v(), -1, -1});
+  const End m = {main.idx(), {t.x[main.idx()], t.ye[main.idx()]}};
+  const int left = deygoutTree(t, rmq, a, m, depth - 1, nodes);
+  const int right = deygoutTree(t, rmq, m, b, depth - 1, nodes);
+  nodes[k].left = left;
+  nodes[k].right = right;
+  return k;
+}
+
+/**
+ * Обход дерева с тем же отсечением, что и при расчете для одной длины волны
+ * @param s       - 1 / корень из длины волны
+ */
+double deygoutAtten(const QVector<Node> &nodes, int k, double s) {
+  if (k < 0) return 0;
+  const double w = atten(nodes[k].v * s);
+  if (w <= 0) return 0;
+  return w + deygoutAtten(nodes, nodes[k].left, s) +
+         deygoutAtten(nodes, nodes[k].right, s);
+}
+
+}  // namespace
+
+QVector<double> loss(const Kernel::Track &t, const Point &a, const Point &b,
+                     const QVector<double> &lambda, const Options &o) {
+  const int m = lambda.size();
+  QVector<double> wp(m, 0.0);
+  const int n = t.size();
+  if (n < 3) return wp;
+
+  if (o.method == Method::Deygout) {
+    const Kernel::RangeMax rmq(t.ye);
+    QVector<Node> nodes;
+    const int root = deygoutTree(t, rmq, {0, a}, {n - 1, b}, o.depth, nodes);
+    for (int j = 0; j < m; ++j)
+      wp[j] = deygoutAtten(nodes, root, 1 / qSqrt(lambda[j]));
+    return wp;
+  }
+
+  // Препятствия Epstein-Peterson и Bullington не зависят от длины волны
+  QVector<Edge> edges;
+  if (o.method == Method::EpsteinPeterson)
+    epsteinPeterson(t, a, b, 1, o.depth, edges);
+  else
+    bullington(t, a, b, 1, edges);
+  for (int j = 0; j < m; ++j) {
+    const double s = 1 / qSqrt(lambda[j]);
+    for (const Edge &e : edges) wp[j] += atten(e.v * s);
+  }
+  return wp;
+}
+
+Result loss(const Kernel::Track &t, const Point &a, const Point &b,
+            double lambda, const Options &o) {
+  Workspace w;
+  Result r;
+  r.wp = loss(t, a, b, lambda, o, w);
+  r.edges = w.edges;
+  return r;
+}
+
+double loss(const Kernel::Track &t, const Point &a, const Point &b,
+            double lambda, const Options &o, Workspace &w) {
+  w.edges.resize(0);
+  const int n = t.size();
+  if (n < 3) return 0;
+
+  switch (o.method) {
+    case Method::Deygout:
+      w.rmq.assign(t.ye);
+      return deygout(t, w.rmq, lambda, {0, a}, {n - 1, b}, o.depth, w.edges);
+    case Method::EpsteinPeterson:
+      return epsteinPeterson(t, a, b, lambda, o.depth, w.edges);
+    case Method::Bullington:
+      return bullington(t, a, b, lambda, w.edges);
+  }
+  return 0;
+}
+
+double shading(const Kernel::Track &t, double lambda) {
+  const int n = t.size();
+  if (n < 2) return 0;
+
+  const int i = std::min_element(t.H.begin(), t.H.end()) - t.H.begin();
+  return atten(shadingParam(-t.H[i], t.x[i] - t.x.first(),
+                            t.ye[i] - t.y.first(), t.x[i] - t.x.last(),
+                            t.ye[i] - t.y.last(), lambda));
+}
+
+double interference(const Kernel::Track &t, const Point &a, const Point &b,
+                    double lambda, const QMap<double, QVector<double>> &c,
+                    Workspace &w) {
+  w.reflections.resize(0);
+  Kernel::reflections(t, a.y, b.y, w.points);
+  if (w.points.isEmpty()) return 0;
+
+  // Для каждой точки отражения считается свое затухание, в расчет идет
+  // наихудшее
+  w.min_H.assign(t.H);
+  double wp = 0;
+  for (int i : w.points) {
+    w.reflections.push_back(Kernel::reflection(t, w.min_H, i, lambda, c));
+    wp = w.reflections.size() == 1 ? w.reflections.last().wp
+                                   : qMax(wp, w.reflections.last().wp);
+  }
+  return wp;
+}
+
+}  // namespace Diffraction
+}  // namespace Calc
+}  // namespace NRrls
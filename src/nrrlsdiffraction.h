@@ -0,0 +1,201 @@
+#ifndef NRRLSDIFFRACTION_H
+#define NRRLSDIFFRACTION_H
+
+#include "nrrlskernel.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Diffraction {
+
+/**
+ * Метод расчета затухания на нескольких препятствиях
+ */
+enum class Method {
+  Deygout,          ///< Главное препятствие с рекурсией по сторонам
+  EpsteinPeterson,  ///< Сумма затуханий по последовательным препятствиям
+  Bullington        ///< Одно эквивалентное препятствие
+};
+
+/**
+ * Параметры расчета дифракции
+ */
+struct Options {
+  Method method = Method::Deygout;
+  int depth = 2;  ///< Глубина рекурсии (Deygout) или число препятствий
+                  ///< (Epstein-Peterson)
+};
+
+/**
+ * Точка трассы: конец интервала или вершина препятствия
+ */
+struct Point {
+  double x;
+  double y;
+};
+
+/**
+ * Препятствие, учтенное в расчете
+ */
+struct Edge {
+  int idx;       ///< Индекс вершины препятствия
+  double v;      ///< Параметр дифракции
+  double atten;  ///< Затухание на препятствии
+};
+
+/**
+ * Результат расчета
+ */
+struct Result {
+  double wp = 0;        ///< Затухание в рельефе
+  QVector<Edge> edges;  ///< Учтенные препятствия
+};
+
+/**
+ * Функция затухания на клиновидном препятствии
+ * @param v       - параметр дифракции
+ * @return Затухание
+ */
+template <typename T>
+T atten(const T &v) {
+  if (v <= -.7)
+    return 0;
+  else
+    return 6.9 + 20 * log10(qSqrt((v - .1) * (v - .1) + 1) + v - .1);
+}
+
+/**
+ * Функция расчета параметра дифракции
+ * @param h       - возвышение препятствия над линией, соединяющей концы
+ * @param d1      - расстояние от левого конца до препятствия
+ * @param d2      - расстояние от правого конца до препятствия
+ * @param lambda  - длина волны
+ * @return Параметр дифракции
+ */
+template <typename T>
+T param(const T &h, const T &d1, const T &d2, const T &lambda) {
+  return h * qSqrt(2 * (d1 + d2) / (lambda * d1 * d2));
+}
+
+/**
+ * Функция расчета параметра дифракции на затеняющем препятствии
+ * полуоткрытого интервала. Расстояния до концов отсчитываются от вершины
+ * препятствия до точек рельефа в концах интервала
+ * @param h       - возвышение препятствия над ЛПВ
+ * @param x1      - расстояние по горизонтали от начала интервала
+ * @param y1      - превышение вершины над началом интервала
+ * @param x2      - расстояние по горизонтали от конца интервала
+ * @param y2      - превышение вершины над концом интервала
+ * @param lambda  - длина волны
+ * @return Параметр дифракции
+ */
+template <typename T, typename X>
+T shadingParam(const T &h, const X &x1, const T &y1, const X &x2,
+               const T &y2, const T &lambda) {
+  const T d1 = qSqrt(y1 * y1 + x1 * x1);
+  const T d2 = qSqrt(y2 * y2 + x2 * x2);
+  return param<T>(h, d1, d2, lambda);
+}
+
+/**
+ * Функция расчета параметра дифракции на эквивалентном препятствии
+ * Bullington: вершина - пересечение касательных из концов
+ * @param s_a     - наибольший наклон прямых из начала к профилю
+ * @param s_b     - наибольший наклон прямых из конца к профилю
+ * @param a       - начало
+ * @param b       - конец
+ * @param lambda  - длина волны
+ * @return Параметр дифракции, вызывается при s_a + s_b > 0
+ */
+template <typename T>
+T bullingtonParam(const T &s_a, const T &s_b, const Point &a, const T &ya,
+                  const Point &b, const T &yb, const T &lambda) {
+  const T x = (yb - ya + s_a * a.x + s_b * b.x) / (s_a + s_b);
+  const T y = ya + s_a * (x - a.x);
+  const T h = y - (ya + (yb - ya) * (x - a.x) / (b.x - a.x));
+  return param<T>(h, x - a.x, b.x - x, lambda);
+}
+
+/**
+ * Рабочие массивы расчета затухания в рельефе. Выделяются один раз и
+ * используются повторно, поэтому многократный расчет на профилях одного
+ * размера не выделяет память
+ */
+struct Workspace {
+  Kernel::RangeMax rmq;    ///< Таблица максимумов высот профиля
+  Kernel::RangeMin min_H;  ///< Таблица минимумов просвета
+  QVector<Edge> edges;     ///< Учтенные препятствия последнего расчета
+  QVector<int> points;     ///< Точки отражения последнего расчета
+  QVector<Kernel::Reflection> reflections;  ///< Параметры точек отражения
+};
+
+/**
+ * Функция расчета затухания в рельефе на закрытом интервале
+ * @param t       - рассчитанный профиль
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param lambda  - длина волны
+ * @param o       - параметры расчета
+ * @return Затухание и учтенные препятствия
+ */
+Result loss(const Kernel::Track &t, const Point &a, const Point &b,
+            double lambda, const Options &o = Options());
+
+/**
+ * Функция расчета затухания в рельефе на закрытом интервале без выделения
+ * памяти
+ * @param t       - рассчитанный профиль
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param lambda  - длина волны
+ * @param o       - параметры расчета
+ * @param w       - рабочие массивы, учтенные препятствия - в w.edges
+ * @return Затухание
+ */
+double loss(const Kernel::Track &t, const Point &a, const Point &b,
+            double lambda, const Options &o, Workspace &w);
+
+/**
+ * Функция расчета затухания на полуоткрытом интервале: на затеняющем
+ * препятствии с минимальным просветом
+ * @param t       - рассчитанный профиль
+ * @param lambda  - длина волны
+ * @return Затухание
+ */
+double shading(const Kernel::Track &t, double lambda);
+
+/**
+ * Функция расчета интерференционного затухания на открытом интервале:
+ * наибольшего по точкам отражения
+ * @param t       - рассчитанный профиль
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param lambda  - длина волны
+ * @param c       - коэффициенты отражения по длинам волн
+ * @param w       - рабочие массивы, точки отражения - в w.reflections
+ * @return Затухание, 0 - точек отражения нет
+ */
+double interference(const Kernel::Track &t, const Point &a, const Point &b,
+                    double lambda, const QMap<double, QVector<double>> &c,
+                    Workspace &w);
+
+/**
+ * Функция расчета затухания в рельефе для набора длин волн. Параметр
+ * дифракции обратно пропорционален корню из длины волны, поэтому
+ * препятствия выбираются один раз, а для каждой длины волны пересчитывается
+ * только затухание на них
+ * @param t       - рассчитанный профиль
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param lambda  - длины волн
+ * @param o       - параметры расчета
+ * @return Затухания по длинам волн
+ */
+QVector<double> loss(const Kernel::Track &t, const Point &a, const Point &b,
+                     const QVector<double> &lambda,
+                     const Options &o = Options());
+
+}  // namespace Diffraction
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSDIFFRACTION_H
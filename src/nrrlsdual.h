@@ -0,0 +1,138 @@
+#ifndef NRRLSDUAL_H
+#define NRRLSDUAL_H
+
+#include <QtMath>
+
+namespace NRrls {
+namespace Calc {
+namespace AD {
+
+/**
+ * Дуальное число для автоматического дифференцирования в прямом режиме.
+ * Вместе со значением переносит частные производные по N входным параметрам
+ */
+template <int N>
+class Dual {
+ public:
+  Dual(double v = 0) : _v(v) {
+    for (int i = 0; i < N; ++i) _d[i] = 0;
+  }
+
+  /**
+   * Входной параметр с единичной производной по самому себе
+   * @param v       - значение
+   * @param i       - номер параметра
+   */
+  static Dual variable(double v, int i) {
+    Dual r(v);
+    r._d[i] = 1;
+    return r;
+  }
+
+  double value() const { return _v; }
+  double d(int i) const { return _d[i]; }
+
+  /**
+   * Функция применения к числу функции с известной производной
+   * @param f       - значение функции
+   * @param df      - производная функции
+   */
+  Dual chain(double f, double df) const {
+    Dual r(f);
+    for (int i = 0; i < N; ++i) r._d[i] = df * _d[i];
+    return r;
+  }
+
+  Dual operator-() const { return chain(-_v, -1); }
+
+  Dual &operator+=(const Dual &o) {
+    _v += o._v;
+    for (int i = 0; i < N; ++i) _d[i] += o._d[i];
+    return *this;
+  }
+
+  Dual &operator-=(const Dual &o) {
+    _v -= o._v;
+    for (int i = 0; i < N; ++i) _d[i] -= o._d[i];
+    return *this;
+  }
+
+  Dual &operator*=(const Dual &o) {
+    for (int i = 0; i < N; ++i) _d[i] = _d[i] * o._v + _v * o._d[i];
+    _v *= o._v;
+    return *this;
+  }
+
+  Dual &operator/=(const Dual &o) {
+    const double inv = 1 / o._v;
+    for (int i = 0; i < N; ++i) _d[i] = (_d[i] - _v * inv * o._d[i]) * inv;
+    _v *= inv;
+    return *this;
+  }
+
+  friend Dual operator+(Dual l, const Dual &r) { return l += r; }
+  friend Dual operator-(Dual l, const Dual &r) { return l -= r; }
+  friend Dual operator*(Dual l, const Dual &r) { return l *= r; }
+  friend Dual operator/(Dual l, const Dual &r) { return l /= r; }
+
+  friend bool operator<(const Dual &l, const Dual &r) { return l._v < r._v; }
+  friend bool operator>(const Dual &l, const Dual &r) { return l._v > r._v; }
+  friend bool operator<=(const Dual &l, const Dual &r) { return l._v <= r._v; }
+  friend bool operator>=(const Dual &l, const Dual &r) { return l._v >= r._v; }
+
+  friend Dual qSqrt(const Dual &x) {
+    const double s = std::sqrt(x._v);
+    return x.chain(s, .5 / s);
+  }
+
+  friend Dual qPow(const Dual &x, double p) {
+    return x.chain(std::pow(x._v, p), p * std::pow(x._v, p - 1));
+  }
+
+  friend Dual qExp(const Dual &x) {
+    const double e = std::exp(x._v);
+    return x.chain(e, e);
+  }
+
+  friend Dual qLn(const Dual &x) { return x.chain(std::log(x._v), 1 / x._v); }
+
+  friend Dual log10(const Dual &x) {
+    return x.chain(std::log10(x._v), 1 / (x._v * M_LN10));
+  }
+
+  friend Dual qCos(const Dual &x) {
+    return x.chain(std::cos(x._v), -std::sin(x._v));
+  }
+
+  friend Dual qAbs(const Dual &x) { return x._v < 0 ? -x : x; }
+
+ private:
+  double _v;
+  double _d[N];
+};
+
+/**
+ * Значение числа без производных
+ */
+inline double value(double x) { return x; }
+
+template <int N>
+double value(const Dual<N> &x) {
+  return x.value();
+}
+
+/**
+ * Функция применения к числу функции с известной производной
+ */
+inline double chain(double, double f, double) { return f; }
+
+template <int N>
+Dual<N> chain(const Dual<N> &x, double f, double df) {
+  return x.chain(f, df);
+}
+
+}  // namespace AD
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSDUAL_H
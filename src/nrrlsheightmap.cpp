@@ -0,0 +1,177 @@
+#include "nrrlsheightmap.h"
+
+#include <thread>
+
+namespace NRrls {
+namespace Calc {
+namespace HeightMap {
+
+namespace {
+
+/**
+ * Профиль и его оболочки, общие для всех клеток карты
+ */
+class Geometry {
+ public:
+  Geometry(const Band::Link &l, double lambda) : lambda(lambda) {
+    Kernel::Track t;
+    t.x = l.track.x;
+    t.y = l.track.y;
+    Kernel::Params p = l.params;
+    p.lambda = lambda;
+    Kernel::profilePass(p, t);
+
+    const int n = t.size();
+    x = t.x;
+    ye = t.ye;
+    raised.resize(n);
+    for (int i = 0; i < n; ++i) raised[i] = t.ye[i] + t.H_null[i];
+    hull = Kernel::upperHull(x, ye, 1, n - 1);
+    hull_open = Kernel::upperHull(x, raised, 1, n - 1);
+    x0 = x.first();
+    xn = x.last();
+    y0 = t.y.first();
+    yn = t.y.last();
+  }
+
+  /**
+   * Высота, которую должна превысить вторая антенна, чтобы ЛПВ из точки
+   * (x0, a) прошла над оболочкой
+   */
+  double border(const QVector<double> &y, const QVector<int> &h,
+                double a) const {
+    const int j = Kernel::tangent(x, y, h, x0, a);
+    return a + (y[j] - a) / (x[j] - x0) * (xn - x0);
+  }
+
+  /**
+   * Затухание на эквивалентном препятствии Bullington
+   */
+  double bullington(double a, double b) const {
+    const int ia = Kernel::tangent(x, ye, hull, x0, a);
+    const int ib = Kernel::tangent(x, ye, hull, xn, b);
+    const double s_a = (ye[ia] - a) / (x[ia] - x0);
+    const double s_b = (ye[ib] - b) / (xn - x[ib]);
+    if (s_a + s_b <= 0) return 0;
+
+    return Diffraction::atten(Diffraction::bullingtonParam(
+        s_a, s_b, {x0, a}, a, {xn, b}, b, lambda));
+  }
+
+  /**
+   * Затухание на затеняющем препятствии полуоткрытого интервала
+   */
+  double shading(double a, double b) const {
+    const double s = (b - a) / (xn - x0);
+    const int k = Kernel::extreme(x, ye, hull, s);
+    const double H = a + s * (x[k] - x0) - ye[k];
+
+    // Просветы в концах интервала равны высотам антенн
+    int i = k;
+    double h = H;
+    if (a - y0 <= H && a - y0 <= b - yn)
+      i = 0, h = a - y0;
+    else if (b - yn < H)
+      i = x.size() - 1, h = b - yn;
+
+    return Diffraction::atten(Diffraction::shadingParam(
+        -h, x[i] - x0, ye[i] - y0, x[i] - xn, ye[i] - yn, lambda));
+  }
+
+  double lambda;
+  QVector<double> x, ye;
+  QVector<double> raised;  ///< Профиль, поднятый на критический просвет
+  QVector<int> hull;       ///< Верхняя оболочка профиля
+  QVector<int> hull_open;  ///< Верхняя оболочка поднятого профиля
+  double x0, xn, y0, yn;
+};
+
+}  // namespace
+
+Result evaluate(const Band::Link &l, double f, double stock,
+                const Options &o) {
+  Result res;
+  if (l.track.size() < 3 || o.step <= 0 || o.max_height < 0) return res;
+
+  const int m = static_cast<int>(o.max_height / o.step + 1e-9) + 1;
+  res.h.resize(m);
+  for (int i = 0; i < m; ++i) res.h[i] = i * o.step;
+  res.type.resize(m * m);
+  res.margin.resize(m * m);
+
+  const Geometry g(l, 3e+8 / (f * 1e+6));
+
+  // Затухания в свободном пространстве, газах и дожде от высот не зависят
+  const Band::Result base = Band::evaluate(l, {f}, {stock});
+  const double level = l.gain - base.ws.first() - base.wa.first() -
+                       base.stock.first();
+
+  int threads = o.threads > 0 ? o.threads
+                              : static_cast<int>(
+                                    std::thread::hardware_concurrency());
+  threads = qBound(1, threads, m);
+
+  auto body = [&](int w) {
+    Band::Link link = l;
+
+    // Затухание на закрытом интервале методом, отличным от Bullington,
+    // рассчитывается по всему профилю, как в основном расчете
+    const bool bullington =
+        l.diffraction.method == Diffraction::Method::Bullington;
+    Kernel::Track track;
+    Kernel::Params params = l.params;
+    params.lambda = g.lambda;
+    Diffraction::Workspace space;
+    if (!bullington) {
+      track.x = l.track.x;
+      track.y = l.track.y;
+    }
+    auto loss = [&](double a, double b) {
+      if (bullington) return g.bullington(a, b);
+      const double s = (b - a) / (g.xn - g.x0);
+      params.los = {s, a - s * g.x0};
+      Kernel::profilePass(params, track);
+      return Diffraction::loss(track, {g.x0, a}, {g.xn, b}, g.lambda,
+                               l.diffraction, space);
+    };
+
+    for (int i = m * w / threads; i < m * (w + 1) / threads; ++i) {
+      const double a = g.y0 + res.h[i];
+      const double closed = g.border(g.ye, g.hull, a);
+      const double opened = g.border(g.raised, g.hull_open, a);
+      for (int j = 0; j < m; ++j) {
+        const double b = g.yn + res.h[j];
+        int &type = res.type[i * m + j];
+        double &margin = res.margin[i * m + j];
+        if (b < closed) {
+          type = 3;
+          margin = level - loss(a, b);
+        } else if (b < opened) {
+          type = 2;
+          margin = level - g.shading(a, b);
+        } else if (o.interference) {
+          type = 1;
+          link.tx = {g.x0, a};
+          link.rx = {g.xn, b};
+          const double s = (b - a) / (g.xn - g.x0);
+          link.params.los = {s, a - s * g.x0};
+          const Band::Result r = Band::evaluate(link, {f}, {stock});
+          margin = r.q.first() - r.stock.first();
+        } else {
+          type = 1;
+          margin = level;
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < threads; ++w) pool.emplace_back(body, w);
+  body(0);
+  for (auto &th : pool) th.join();
+  return res;
+}
+
+}  // namespace HeightMap
+}  // namespace Calc
+}  // namespace NRrls
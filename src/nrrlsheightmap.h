@@ -0,0 +1,61 @@
+#ifndef NRRLSHEIGHTMAP_H
+#define NRRLSHEIGHTMAP_H
+
+#include "nrrlsband.h"
+
+namespace NRrls {
+namespace Calc {
+namespace HeightMap {
+
+/**
+ * Параметры карты
+ */
+struct Options {
+  double max_height = 100;  ///< Наибольшая высота подвеса (в метрах)
+  double step = 1;          ///< Шаг сетки высот (в метрах)
+  bool interference = false;  ///< Учитывать интерференцию на открытом
+                              ///< интервале (расчет по всему профилю)
+  int threads = 0;  ///< Число потоков, 0 - по числу ядер
+};
+
+/**
+ * Карта типа интервала и запаса связи по парам высот
+ */
+struct Result {
+  QVector<double> h;  ///< Значения высот по обеим осям (в метрах)
+  QVector<int> type;  ///< Типы интервала: type[i * h.size() + j] для высоты
+                      ///< первой антенны h[i] и второй h[j]
+  QVector<double> margin;  ///< Запасы связи сверх требуемого, в том же
+                           ///< порядке
+};
+
+/**
+ * Функция построения карты типа интервала и запаса связи по парам высот
+ * подвеса антенн. Профиль просматривается один раз: строятся верхние
+ * выпуклые оболочки профиля и профиля, поднятого на критический просвет.
+ * Для строки карты по касательным из первой антенны находятся границы
+ * закрытого и открытого интервала, после чего тип каждой клетки
+ * определяется сравнением. Затеняющее препятствие полуоткрытого интервала
+ * и эквивалентное препятствие закрытого ищутся двоичным поиском по
+ * оболочке, поэтому на клетку приходится O(log n) операций. На закрытом
+ * интервале используется метод l.diffraction: препятствие Bullington
+ * определяется касательными к оболочке, для остальных методов затухание
+ * рассчитывается по всему профилю, как в основном расчете, и клетка
+ * закрытого интервала обходится в O(n) операций. Затухания, не зависящие
+ * от высот, и требуемый запас рассчитываются один раз. Строки
+ * распределяются по потокам
+ * @param l       - параметры интервала, высоты антенн в tx и rx не
+ *                  используются
+ * @param f       - частота (в МГц)
+ * @param stock   - требуемый запас связи без учета дождя (в дБ)
+ * @param o       - параметры карты
+ * @return Карта
+ */
+Result evaluate(const Band::Link &l, double f, double stock,
+                const Options &o);
+
+}  // namespace HeightMap
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSHEIGHTMAP_H
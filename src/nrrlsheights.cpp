@@ -0,0 +1,196 @@
+#include "nrrlsheights.h"
+
+#include <thread>
+
+namespace NRrls {
+namespace Calc {
+namespace Heights {
+
+namespace {
+
+/**
+ * Проверка запаса связи для пары высот полным расчетом интервала
+ */
+class Margin {
+ public:
+  Margin(const Band::Link &l, double f, double stock)
+      : _l(l), _f(1, f), _stock(1, stock) {}
+
+  bool operator()(double h1, double h2) {
+    const double x0 = _l.track.x.first(), xn = _l.track.x.last();
+    _l.tx = {x0, _l.track.y.first() + h1};
+    _l.rx = {xn, _l.track.y.last() + h2};
+    const double a = (_l.rx.y - _l.tx.y) / (xn - x0);
+    _l.params.los = {a, _l.tx.y - a * x0};
+
+    const Band::Result r = Band::evaluate(_l, _f, _stock);
+    return r.q.first() >= r.stock.first();
+  }
+
+ private:
+  Band::Link _l;
+  QVector<double> _f;
+  QVector<double> _stock;
+};
+
+/**
+ * Наименьшая высота второй антенны для открытого интервала
+ */
+class Opened {
+ public:
+  Opened(const Band::Link &l, double f)
+      : _x(l.track.x), _lambda(3e+8 / (f * 1e+6)) {
+    Kernel::Track t;
+    t.x = l.track.x;
+    t.y = l.track.y;
+    Kernel::Params p = l.params;
+    p.lambda = _lambda;
+    Kernel::profilePass(p, t);
+
+    // Открытый интервал: ЛПВ не ниже профиля, поднятого на критический
+    // просвет, то есть не ниже его верхней оболочки
+    const int n = t.size();
+    _y.resize(n);
+    for (int i = 0; i < n; ++i) _y[i] = t.ye[i] + t.H_null[i];
+    _hull = Kernel::upperHull(_x, _y, 1, n - 1);
+    _y0 = t.y.first();
+    _yn = t.y.last();
+    _ye_min = *std::min_element(t.ye.begin() + 1, t.ye.end() - 1);
+  }
+
+  double operator()(double h1) const {
+    if (_hull.isEmpty()) return 0;
+    const double x0 = _x.first(), a = _y0 + h1;
+    const int j = Kernel::tangent(_x, _y, _hull, x0, a);
+    const double b = a + (_y[j] - a) / (_x[j] - x0) * (_x.last() - x0);
+    return qMax(b - _yn, 0.0);
+  }
+
+  /**
+   * Наименьший период интерференционных лепестков по высоте второй
+   * антенны. Разность хода прямой и отраженной волн 2 * h1' * h2' / L, где
+   * h1', h2' - высоты антенн над точкой отражения, поэтому лепесток по h2
+   * занимает lambda * L / (2 * h1'). Точка отражения не ниже наименьшей
+   * высоты профиля
+   */
+  double period(double h1) const {
+    const double h = qMax(_y0 + h1 - _ye_min, 1.0);
+    return _lambda * (_x.last() - _x.first()) / (2 * h);
+  }
+
+ private:
+  const QVector<double> &_x;
+  const double _lambda;
+  QVector<double> _y;  ///< Профиль, поднятый на критический просвет
+  QVector<int> _hull;
+  double _y0, _yn;
+  double _ye_min;  ///< Наименьшая высота профиля с учетом земной поверхности
+};
+
+/**
+ * Число шагов просмотра на интерференционный лепесток
+ */
+const int lobe_steps = 8;
+
+/**
+ * Функция поиска наименьшей высоты второй антенны с запасом связи не меньше
+ * требуемого. Ниже границы открытого интервала затухание в рельефе убывает
+ * с ростом высоты, поэтому высота ищется делением отрезка. Выше границы
+ * затухание определяется интерференцией и осциллирует по высоте, поэтому
+ * лепестки просматриваются с шагом в lobe_steps раз меньше периода, и
+ * деление отрезка ведется между последней недостаточной и первой
+ * достаточной высотой
+ * @param margin  - проверка запаса связи
+ * @param h1      - высота первой антенны
+ * @param opened  - высота второй антенны, с которой интервал открыт
+ * @param period  - наименьший период лепестков
+ * @param top     - наибольшая высота
+ * @param tol     - точность
+ * @return Высота, -1 - недостижимо в пределах top
+ */
+double lowest(Margin &margin, double h1, double opened, double period,
+              double top, double tol) {
+  if (margin(h1, 0)) return 0;
+
+  auto bisect = [&](double lo, double hi) {
+    while (hi - lo > tol) {
+      const double mid = (lo + hi) / 2;
+      (margin(h1, mid) ? hi : lo) = mid;
+    }
+    return hi;
+  };
+
+  // Полуоткрытый и закрытый интервал: запас растет с высотой
+  const double below = qMin(opened - tol / 2, top);
+  if (below > 0 && margin(h1, below)) return bisect(0, below);
+
+  // Открытый интервал: просмотр лепестков
+  const double step = qMax(period / lobe_steps, tol);
+  double lo = qMax(below, 0.0);
+  for (double h = qMax(opened, lo); h <= top; h += step) {
+    if (margin(h1, h)) return bisect(lo, h);
+    lo = h;
+  }
+  if (lo < top && margin(h1, top)) return bisect(lo, top);
+  return -1;
+}
+
+}  // namespace
+
+Result optimize(const Band::Link &l, double f, double stock,
+                const Options &o) {
+  Result res;
+  if (l.track.size() < 3 || o.step <= 0 || o.max_height < 0) return res;
+
+  const int n = static_cast<int>(o.max_height / o.step + 1e-9) + 1;
+  res.h1s.resize(n);
+  res.h2s.resize(n);
+  for (int i = 0; i < n; ++i) res.h1s[i] = i * o.step;
+
+  const double tol = o.tolerance > 0 ? o.tolerance : .01;
+  const Opened opened(l, f);
+
+  int threads = o.threads > 0 ? o.threads
+                              : static_cast<int>(
+                                    std::thread::hardware_concurrency());
+  threads = qBound(1, threads, n);
+
+  // Высоты первой антенны распределяются по потокам блоками
+  auto body = [&](int w) {
+    Margin margin(l, f, stock);
+    const int begin = n * w / threads, end = n * (w + 1) / threads;
+    for (int i = begin; i < end; ++i) {
+      const double h1 = res.h1s[i];
+      double &h2 = res.h2s[i];
+      if (o.goal == Goal::Opened) {
+        h2 = qCeil(opened(h1) / tol) * tol;
+        if (h2 > o.max_height) h2 = -1;
+        continue;
+      }
+      h2 = lowest(margin, h1, opened(h1), opened.period(h1), o.max_height,
+                  tol);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < threads; ++w) pool.emplace_back(body, w);
+  body(0);
+  for (auto &th : pool) th.join();
+
+  for (int i = 0; i < n; ++i) {
+    if (res.h2s[i] < 0) continue;
+    const double c = o.cost ? o.cost(res.h1s[i], res.h2s[i])
+                            : res.h1s[i] + res.h2s[i];
+    if (!res.found || c < res.cost) {
+      res.found = true;
+      res.h1 = res.h1s[i];
+      res.h2 = res.h2s[i];
+      res.cost = c;
+    }
+  }
+  return res;
+}
+
+}  // namespace Heights
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,76 @@
+#ifndef NRRLSHEIGHTS_H
+#define NRRLSHEIGHTS_H
+
+#include <functional>
+
+#include "nrrlsband.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Heights {
+
+/**
+ * Условие, которому должна удовлетворять пара высот
+ */
+enum class Goal {
+  Opened,  ///< Открытый интервал
+  Margin   ///< Запас связи не меньше требуемого
+};
+
+/**
+ * Параметры поиска
+ */
+struct Options {
+  Goal goal = Goal::Opened;
+  double max_height = 100;  ///< Наибольшая высота подвеса (в метрах)
+  double step = 1;  ///< Шаг перебора высоты первой антенны (в метрах)
+  double tolerance = .01;  ///< Точность высоты второй антенны (в метрах)
+  std::function<double(double, double)> cost;  ///< Стоимость пары высот,
+                                               ///< пустая - сумма высот
+  int threads = 0;  ///< Число потоков, 0 - по числу ядер
+};
+
+/**
+ * Результат поиска
+ */
+struct Result {
+  bool found = false;  ///< Найдена ли допустимая пара
+  double h1 = 0;       ///< Высота первой антенны (в метрах)
+  double h2 = 0;       ///< Высота второй антенны (в метрах)
+  double cost = 0;     ///< Стоимость пары
+  QVector<double> h1s;  ///< Высоты первой антенны
+  QVector<double> h2s;  ///< Наименьшие допустимые высоты второй антенны,
+                        ///< -1 - недостижимо в пределах max_height
+};
+
+/**
+ * Функция поиска наименьшей пары высот подвеса антенн. Просвет растет с
+ * высотой антенн, поэтому для каждой высоты первой антенны ищется
+ * наименьшая высота второй. Для открытого интервала она находится точно:
+ * ЛПВ должна проходить над верхней выпуклой оболочкой точек профиля,
+ * поднятых на критический просвет, и касательная к оболочке ищется двоичным
+ * поиском. Для запаса связи высота ищется делением отрезка только ниже
+ * этой границы, где затухание в рельефе убывает с высотой. Выше нее
+ * затухание определяется интерференцией и осциллирует, поэтому лепестки
+ * просматриваются с шагом меньше их периода, и отрезок делится между
+ * последней недостаточной и первой достаточной высотой. Найденная высота
+ * всегда дает достаточный запас, но более низкое окно с достаточным
+ * запасом может быть пропущено, если оно уже шага просмотра или возникает
+ * скачком при смене затеняющего препятствия или точки отражения. Высоты
+ * первой антенны распределяются по потокам
+ * @param l       - параметры интервала, высоты антенн в tx и rx не
+ *                  используются
+ * @param f       - частота (в МГц)
+ * @param stock   - требуемый запас связи без учета дождя (в дБ)
+ * @param o       - параметры поиска
+ * @return Пара высот с наименьшей стоимостью и наименьшие высоты второй
+ * антенны по высотам первой
+ */
+Result optimize(const Band::Link &l, double f, double stock,
+                const Options &o);
+
+}  // namespace Heights
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSHEIGHTS_H
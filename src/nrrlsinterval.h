@@ -0,0 +1,125 @@
+#ifndef NRRLSINTERVAL_H
+#define NRRLSINTERVAL_H
+
+#include <QtMath>
+
+namespace NRrls {
+namespace Calc {
+namespace IA {
+
+/**
+ * Интервал значений для интервальной арифметики. Результат каждой операции
+ * содержит все значения, которые она может принять при аргументах из
+ * интервалов (без учета ошибок округления)
+ */
+class Interval {
+ public:
+  Interval(double v = 0) : _lo(v), _hi(v) {}
+  Interval(double lo, double hi) : _lo(lo), _hi(hi) {}
+
+  double lo() const { return _lo; }
+  double hi() const { return _hi; }
+  double mid() const { return (_lo + _hi) / 2; }
+  double width() const { return _hi - _lo; }
+  bool contains(double v) const { return _lo <= v && v <= _hi; }
+
+  Interval operator-() const { return Interval(-_hi, -_lo); }
+
+  Interval &operator+=(const Interval &o) {
+    _lo += o._lo;
+    _hi += o._hi;
+    return *this;
+  }
+
+  Interval &operator-=(const Interval &o) {
+    const double lo = _lo - o._hi;
+    _hi -= o._lo;
+    _lo = lo;
+    return *this;
+  }
+
+  Interval &operator*=(const Interval &o) {
+    const double a = _lo * o._lo, b = _lo * o._hi, c = _hi * o._lo,
+                 d = _hi * o._hi;
+    _lo = qMin(qMin(a, b), qMin(c, d));
+    _hi = qMax(qMax(a, b), qMax(c, d));
+    return *this;
+  }
+
+  Interval &operator/=(const Interval &o) {
+    if (o.contains(0)) return *this = Interval(-HUGE_VAL, HUGE_VAL);
+    return *this *= Interval(1 / o._hi, 1 / o._lo);
+  }
+
+  friend Interval operator+(Interval l, const Interval &r) { return l += r; }
+  friend Interval operator-(Interval l, const Interval &r) { return l -= r; }
+  friend Interval operator*(Interval l, const Interval &r) { return l *= r; }
+  friend Interval operator/(Interval l, const Interval &r) { return l /= r; }
+
+  // Сравнения истинны, только если выполняются для всех значений
+  friend bool operator<(const Interval &l, const Interval &r) {
+    return l._hi < r._lo;
+  }
+  friend bool operator>(const Interval &l, const Interval &r) {
+    return l._lo > r._hi;
+  }
+  friend bool operator<=(const Interval &l, const Interval &r) {
+    return l._hi <= r._lo;
+  }
+  friend bool operator>=(const Interval &l, const Interval &r) {
+    return l._lo >= r._hi;
+  }
+
+  friend Interval qMin(const Interval &l, const Interval &r) {
+    return Interval(qMin(l._lo, r._lo), qMin(l._hi, r._hi));
+  }
+
+  friend Interval qMax(const Interval &l, const Interval &r) {
+    return Interval(qMax(l._lo, r._lo), qMax(l._hi, r._hi));
+  }
+
+  friend Interval qSqrt(const Interval &x) {
+    return Interval(std::sqrt(qMax(x._lo, 0.0)), std::sqrt(qMax(x._hi, 0.0)));
+  }
+
+  friend Interval qExp(const Interval &x) {
+    return Interval(std::exp(x._lo), std::exp(x._hi));
+  }
+
+  friend Interval qLn(const Interval &x) {
+    return Interval(std::log(x._lo), std::log(x._hi));
+  }
+
+  friend Interval log10(const Interval &x) {
+    return Interval(std::log10(x._lo), std::log10(x._hi));
+  }
+
+  friend Interval qCos(const Interval &x) {
+    if (x.width() >= 2 * M_PI) return Interval(-1, 1);
+    const double a = std::cos(x._lo), b = std::cos(x._hi);
+    Interval r(qMin(a, b), qMax(a, b));
+    // Экстремумы внутри интервала: cos = 1 в 2пk, cos = -1 в п(2k + 1)
+    if (std::floor(x._hi / (2 * M_PI)) > std::floor(x._lo / (2 * M_PI)))
+      r._hi = 1;
+    if (std::floor((x._hi - M_PI) / (2 * M_PI)) >
+        std::floor((x._lo - M_PI) / (2 * M_PI)))
+      r._lo = -1;
+    return r;
+  }
+
+  friend Interval qAbs(const Interval &x) {
+    if (x._lo >= 0) return x;
+    if (x._hi <= 0) return -x;
+    return Interval(0, qMax(-x._lo, x._hi));
+  }
+
+ private:
+  double _lo;
+  double _hi;
+};
+
+}  // namespace IA
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSINTERVAL_H
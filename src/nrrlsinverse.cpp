@@ -0,0 +1,49 @@
+#include "nrrlsinverse.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Inverse {
+
+double maxProb(const Link &l, const Required &r, double eps) {
+  const double q = margin(l);
+
+  // Невязка возрастает с ростом процента времени
+  auto g = [&](double u) { return q - r(qPow(10.0, u)); };
+  double a = -4, b = log10(50.0);
+  double ga = g(a), gb = g(b);
+  if (ga >= 0) return 100 - qPow(10.0, a);
+  if (gb < 0) return 0;
+
+  int side = 0;
+  for (int i = 0; i < 100 && b - a > eps; ++i) {
+    const double u = (a * gb - b * ga) / (gb - ga);
+    const double gu = g(u);
+    if (gu >= 0) {
+      b = u, gb = gu;
+      // Illinois: ослабление конца, который не сдвигался два шага подряд
+      if (side == -1) ga /= 2;
+      side = -1;
+    } else {
+      a = u, ga = gu;
+      if (side == 1) gb /= 2;
+      side = 1;
+    }
+    if (gu == 0) break;
+  }
+  return 100 - qPow(10.0, b);
+}
+
+Result evaluate(const Link &l, const Required &r, double prob) {
+  Result res;
+  res.q = margin(l);
+  res.stock = r(100 - prob);
+  res.power = minPower(l, res.stock);
+  res.feeder = maxFeeder(l, res.stock);
+  res.relief = maxRelief(l, res.stock);
+  res.prob = maxProb(l, r);
+  return res;
+}
+
+}  // namespace Inverse
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,153 @@
+#ifndef NRRLSINVERSE_H
+#define NRRLSINVERSE_H
+
+#include <QPair>
+
+#include "nrrlsatmosphere.h"
+#include "nrrlsbudget.h"
+#include "nrrlsstock.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Inverse {
+
+/**
+ * Составляющие энергетического расчета, как в Median::Item
+ */
+struct Link {
+  QPair<double, double> p = {0, 0};   ///< Мощности передатчиков (в Вт)
+  QPair<double, double> c = {0, 0};   ///< КУ антенн (в дБ)
+  QPair<double, double> wf = {0, 0};  ///< Потери в фидерах (в дБ)
+  double ws = 0;  ///< Затухание в свободном пространстве
+  double wa = 0;  ///< Затухание в газах атмосферы
+  double wp = 0;  ///< Затухание в рельефе
+  double s = 0;   ///< Чувствительность приемника (в дБ относительно 1 мкВ)
+};
+
+/**
+ * Результат обратного расчета
+ */
+struct Result {
+  double q = 0;      ///< Запас связи
+  double stock = 0;  ///< Требуемый запас связи
+  double power = 0;  ///< Наименьшая мощность передатчиков (в Вт)
+  QPair<double, double> feeder = {0, 0};  ///< Наибольшие потери в каждом
+                                          ///< фидере при неизменном другом
+  double relief = 0;  ///< Наибольшее затухание в рельефе
+  double prob = 0;    ///< Наибольшая вероятность связи (в %), 0 - требуемый
+                      ///< запас не достигается ни при какой вероятности
+};
+
+/**
+ * Сумма усилений и потерь на интервале без мощности передатчика (в дБ).
+ * Медианные уровни обоих приемников отличаются только мощностями
+ */
+inline double gain(const Link &l) {
+  return l.c.first + l.c.second - l.wf.first - l.wf.second - l.ws - l.wa -
+         l.wp;
+}
+
+/**
+ * Чувствительность приемника в дБВт
+ */
+inline double toDbvt(const Link &l) { return Budget::toDbvt(l.s); }
+
+/**
+ * Функция расчета запаса связи, как в Acceptable::Item
+ */
+inline double margin(const Link &l) {
+  return 10 * log10(qMin(l.p.first, l.p.second)) + gain(l) - toDbvt(l);
+}
+
+/**
+ * Функция расчета наименьшей мощности передатчиков, при которой запас связи
+ * равен требуемому. Уровень линеен по мощности в дБ, поэтому обращение
+ * точное
+ * @param l       - составляющие расчета, мощности не используются
+ * @param stock   - требуемый запас связи
+ * @return Мощность (в Вт)
+ */
+inline double minPower(const Link &l, double stock) {
+  return qPow(10.0, (stock + toDbvt(l) - gain(l)) / 10);
+}
+
+/**
+ * Функция расчета наибольших потерь в фидере, при которых запас связи равен
+ * требуемому. Потери фидера входят в уровни обоих приемников, поэтому запас
+ * можно израсходовать в любом из фидеров
+ * @param l       - составляющие расчета
+ * @param stock   - требуемый запас связи
+ * @return Потери в первом фидере при неизменном втором и наоборот
+ */
+inline QPair<double, double> maxFeeder(const Link &l, double stock) {
+  const double d = margin(l) - stock;
+  return {l.wf.first + d, l.wf.second + d};
+}
+
+/**
+ * Функция расчета наибольшего затухания в рельефе, при котором запас связи
+ * равен требуемому
+ * @param l       - составляющие расчета
+ * @param stock   - требуемый запас связи
+ */
+inline double maxRelief(const Link &l, double stock) {
+  return l.wp + margin(l) - stock;
+}
+
+/**
+ * Требуемый запас связи с учетом дождя в зависимости от процента времени,
+ * как в Acceptable::Item и Rain::Item
+ */
+class Required {
+ public:
+  /**
+   * @param stocks  - таблица требуемых запасов
+   * @param f       - частота (в МГц)
+   * @param rain    - параметры интервала для расчета затухания в дожде
+   */
+  Required(const Stock::Table &stocks, double f,
+           const Atmosphere::Rain::Link &rain)
+      : _stocks(stocks),
+        _f(f),
+        _rain(QVector<Atmosphere::Rain::Link>(1, rain)) {}
+
+  /**
+   * @param t       - процент времени, в течение которого допускается
+   *                  перерыв связи
+   * @return Требуемый запас (в дБ)
+   */
+  double operator()(double t) const {
+    return _stocks(_f, t) + _rain.attenuation(0, t);
+  }
+
+ private:
+  const Stock::Table &_stocks;
+  double _f;
+  Atmosphere::Rain::Batch _rain;
+};
+
+/**
+ * Функция расчета наибольшей вероятности связи, при которой запас связи не
+ * меньше требуемого. Требуемый запас не возрастает с ростом процента
+ * времени и нелинеен по нему, поэтому процент находится методом хорд с
+ * модификацией Illinois по логарифму процента на отрезке 1e-4...50%
+ * @param l       - составляющие расчета
+ * @param r       - требуемый запас по проценту времени
+ * @param eps     - допустимая погрешность логарифма процента
+ * @return Вероятность (в %), 0 - запас не достигается
+ */
+double maxProb(const Link &l, const Required &r, double eps = 1e-6);
+
+/**
+ * Функция обратного расчета по всем величинам
+ * @param l       - составляющие расчета
+ * @param r       - требуемый запас по проценту времени
+ * @param prob    - заданная вероятность связи (в %)
+ */
+Result evaluate(const Link &l, const Required &r, double prob);
+
+}  // namespace Inverse
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSINVERSE_H
@@ -0,0 +1,385 @@
+#include "nrrlskernel.h"
+#include "nrrlssimd.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Kernel {
+
+void Track::resize(void) {
+  const int n = x.size();
+  earth.resize(n);
+  ye.resize(n);
+  los.resize(n);
+  H.resize(n);
+  H_null.resize(n);
+  h_null.resize(n);
+  fr_up.resize(n);
+  fr_dw.resize(n);
+}
+
+Extrema profilePass(const Params &p, Track &t) {
+  t.resize();
+
+  Extrema e;
+  const int n = t.size();
+  if (!n) return e;
+
+  Simd::Reduce r;
+  Simd::profile(Simd::Coef(p, t.x.first()), t, 0, n, r);
+  t.H_null[n - 1] = 0;
+
+  e.min_H = r.min_H;
+  e.min_H_margin = r.min_H_margin;
+  e.min_H_idx = r.min_H_idx;
+  e.type = intervalType(e, t);
+  return e;
+}
+
+int intervalType(const Extrema &e, const Track &t) {
+  if (t.x.isEmpty()) return 0;
+  if (e.min_H < 0) return 3;
+  if (e.min_H_margin >= 0) return 1;
+
+  // Просвет меньше критического хотя бы в одной точке. Если минимальный
+  // просвет положителен, то эта точка и дает полуоткрытый интервал
+  if (e.min_H > 0) return 2;
+
+  bool opened = false;
+  for (int i = 0; i < t.size(); ++i) {
+    if (t.H[i] > 0 && t.H[i] < t.H_null[i]) return 2;
+    opened = opened || t.H[i] >= t.H_null[i];
+  }
+  return opened ? 1 : 0;
+}
+
+namespace {
+
+/**
+ * Число точек профиля, обрабатываемых за один шаг совмещенного прохода:
+ * рассчитанный блок массивов профиля остается в кэше до свертки по зонам
+ */
+const int clearance_block = 1024;
+
+/**
+ * Свертка просветов по зонам на участке рассчитанного профиля
+ */
+class ZoneReduce {
+ public:
+  ZoneReduce(const Params &p, const Track &t, const QVector<Zone> &zones,
+             Clearance &c)
+      : _k(p, t.x.isEmpty() ? 0 : t.x.first()), _t(t), _c(c) {
+    const int m = zones.size();
+    c.margin.fill(HUGE_VAL, m);
+    c.ratio.fill(HUGE_VAL, m);
+    c.idx.fill(0, m);
+    c.type.fill(0, m);
+    c.min_H = HUGE_VAL;
+
+    // Требуемый просвет зоны: coef * sqrt(k * (1 - k))
+    _coef.resize(m);
+    _positive.fill(HUGE_VAL, m);
+    for (int z = 0; z < m; ++z)
+      _coef[z] = zones[z].fraction *
+                 qSqrt(zones[z].number * (3e+8 / (zones[z].f * 1e+6)) *
+                       p.area_length);
+  }
+
+  /**
+   * Свертка точек [begin, end), просветы H которых уже рассчитаны
+   */
+  void operator()(int begin, int end) {
+    const int n = _t.size(), m = _coef.size();
+    const double *x = _t.x.constData(), *H = _t.H.constData();
+    const double *cz = _coef.constData();
+    double *margin = _c.margin.data(), *ratio = _c.ratio.data(),
+           *pos = _positive.data();
+    int *idx = _c.idx.data();
+
+    for (int i = begin; i < end; ++i) {
+      const double kx = (x[i] - _k.x0) * _k.inv_l;
+      const double s = i + 1 < n ? qSqrt(qMax(kx * (1 - kx), 0.0)) : 0;
+      _c.min_H = qMin(_c.min_H, H[i]);
+
+      for (int z = 0; z < m; ++z) {
+        const double r = cz[z] * s;
+        margin[z] = qMin(margin[z], H[i] - r);
+        if (H[i] > 0) pos[z] = qMin(pos[z], H[i] - r);
+        if (r > 0 && H[i] / r < ratio[z]) ratio[z] = H[i] / r, idx[z] = i;
+      }
+    }
+  }
+
+  /**
+   * Типы интервала по зонам после свертки всего профиля
+   */
+  void finish() {
+    // Пустой профиль не определяет ни просвет, ни тип интервала
+    if (!_t.size()) {
+      _c.min_H = 0;
+      return;
+    }
+
+    // Как в intervalType: при нулевом минимальном просвете интервал
+    // полуоткрыт, если есть точка с положительным просветом меньше
+    // требуемого
+    for (int z = 0; z < _coef.size(); ++z) {
+      if (_c.min_H < 0)
+        _c.type[z] = 3;
+      else if (_c.margin[z] >= 0)
+        _c.type[z] = 1;
+      else
+        _c.type[z] = (_c.min_H > 0 || _positive[z] < 0) ? 2 : 1;
+    }
+  }
+
+ private:
+  const Simd::Coef _k;
+  const Track &_t;
+  Clearance &_c;
+  QVector<double> _coef;      ///< Множители требуемого просвета по зонам
+  QVector<double> _positive;  ///< Минимальные H - R по точкам с H > 0
+};
+
+}  // namespace
+
+Extrema profilePass(const Params &p, Track &t, const QVector<Zone> &zones,
+                    Clearance &c) {
+  t.resize();
+
+  Extrema e;
+  const int n = t.size();
+  ZoneReduce zone(p, t, zones, c);
+  if (!n) {
+    zone.finish();
+    return e;
+  }
+
+  // Профиль рассчитывается блоками, и каждый блок сворачивается по зонам
+  // сразу после расчета, поэтому второго прохода по памяти нет
+  const Simd::Coef k(p, t.x.first());
+  Simd::Reduce r;
+  for (int begin = 0; begin < n; begin += clearance_block) {
+    const int end = qMin(begin + clearance_block, n);
+    Simd::profile(k, t, begin, end, r);
+    zone(begin, end);
+  }
+  t.H_null[n - 1] = 0;
+  zone.finish();
+
+  e.min_H = r.min_H;
+  e.min_H_margin = r.min_H_margin;
+  e.min_H_idx = r.min_H_idx;
+  e.type = intervalType(e, t);
+  return e;
+}
+
+Clearance clearance(const Params &p, const Track &t,
+                    const QVector<Zone> &zones) {
+  Clearance c;
+  ZoneReduce zone(p, t, zones, c);
+  zone(0, t.size());
+  zone.finish();
+  return c;
+}
+
+bool mergeable(double l, double r1, double r2) {
+  return log10(M_PI - qAsin(qSqrt(l * (r2 - r1) / (r2 * (l - r1))))) > 0.408;
+}
+
+QVector<Obstacle> obstacles(const Track &t) {
+  QVector<Obstacle> v;
+  const int n = t.size();
+  if (!n) return v;
+
+  const double *x = t.x.constData();
+  const double *ye = t.ye.constData();
+  const double *los = t.los.constData();
+  const double x0 = x[0], l = x[n - 1] - x[0];
+
+  // Очередное препятствие либо добавляется, либо сливается с последним
+  // добавленным, поэтому вершины сравниваются за O(1)
+  auto push = [&](const Obstacle &o) {
+    if (!v.isEmpty() &&
+        mergeable(l, x[v.last().top] - x0, x[o.top] - x0)) {
+      Obstacle &last = v.last();
+      last.end = o.end;
+      if (ye[o.top] > ye[last.top]) last.top = o.top;
+      last.merged += o.merged;
+    } else {
+      v.push_back(o);
+    }
+  };
+
+  bool inside = false;
+  Obstacle o;
+  for (int i = 0; i < n; ++i) {
+    if (!inside && ye[i] >= los[i]) {
+      inside = true;
+      o.begin = o.top = i;
+    } else if (inside && ye[i] <= los[i]) {
+      inside = false;
+      o.end = i;
+      push(o);
+    }
+    if (inside && ye[i] > ye[o.top]) o.top = i;
+  }
+  if (inside) {
+    o.end = n - 1;
+    push(o);
+  }
+
+  return v;
+}
+
+QVector<int> crossings(const Track &t, const QPair<double, double> &line) {
+  QVector<int> v;
+  crossings(t, line, v);
+  return v;
+}
+
+void crossings(const Track &t, const QPair<double, double> &line,
+               QVector<int> &v) {
+  v.resize(0);
+  const int n = t.size();
+  if (n < 2) return;
+
+  const double *x = t.x.constData();
+  const double *ye = t.ye.constData();
+  const double a = line.first, b = line.second;
+
+  // Пересечения выбираются по смене знака превышения профиля над прямой
+  double d = ye[0] - (a * x[0] + b);
+  for (int i = 0; i + 1 < n; ++i) {
+    const double next = ye[i + 1] - (a * x[i + 1] + b);
+    if ((d > 0) != (next > 0)) {
+      const int idx = qAbs(d) <= qAbs(next) ? i : i + 1;
+      if (v.isEmpty() || v.last() != idx) v.push_back(idx);
+    }
+    d = next;
+  }
+}
+
+void reflections(const Track &t, double a, double b, QVector<int> &v) {
+  if (t.size() < 2) {
+    v.resize(0);
+    return;
+  }
+  const double x0 = t.x.first();
+  const double mirror = 2 * t.y.first() - a;
+  const double s = (b - mirror) / (t.x.last() - x0);
+  crossings(t, {s, mirror - s * x0}, v);
+}
+
+QVector<int> upperHull(const QVector<double> &x, const QVector<double> &y,
+                       int begin, int end) {
+  QVector<int> h;
+  for (int i = begin; i < end; ++i) {
+    // Вершина удаляется, если не лежит строго выше хорды соседей
+    while (h.size() >= 2) {
+      const int a = h[h.size() - 2], b = h.last();
+      const double cross =
+          (x[b] - x[a]) * (y[i] - y[a]) - (y[b] - y[a]) * (x[i] - x[a]);
+      if (cross < 0) break;
+      h.pop_back();
+    }
+    h.push_back(i);
+  }
+  return h;
+}
+
+int tangent(const QVector<double> &x, const QVector<double> &y,
+            const QVector<int> &hull, double px, double py) {
+  const double d = px < x[hull.first()] ? 1 : -1;
+  int lo = 0, hi = hull.size() - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    const int a = hull[mid], b = hull[mid + 1];
+    // Угол возвышения вершины b не меньше, чем вершины a
+    if ((y[b] - py) * (x[a] - px) * d >= (y[a] - py) * (x[b] - px) * d)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return hull[lo];
+}
+
+int extreme(const QVector<double> &x, const QVector<double> &y,
+            const QVector<int> &hull, double slope) {
+  int lo = 0, hi = hull.size() - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    const int a = hull[mid], b = hull[mid + 1];
+    if (y[b] - y[a] > slope * (x[b] - x[a]))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return hull[lo];
+}
+
+int roughness(const Track &t, int begin, int end, double scale) {
+  const double *x = t.x.constData(), *ye = t.ye.constData();
+  const double *H_null = t.H_null.constData(), *h_null = t.h_null.constData();
+  const double a = (ye[end] - ye[begin]) / (x[end] - x[begin]);
+  const double b = ye[begin] - a * x[begin];
+
+  int res = 0;
+  double delta_h_max = 0;
+  for (int i = begin; i < end; ++i) {
+    const double delta_h = qAbs(ye[i] - (a * x[i] + b));
+    const double h0 = H_null[i] * scale;
+    const double h_max = 0.75 * (h0 - h_null[i] / scale);
+    if (delta_h <= h_max)
+      continue;
+    else if (delta_h < h0)
+      res = std::max(res, 1);
+    else
+      res = 2;
+    delta_h_max = std::max(delta_h_max, delta_h);
+  }
+  if (qAbs(delta_h_max) - .1 <= 0) res = 3;
+  return res;
+}
+
+double reflectionCoef(const QMap<double, QVector<double>> &c, int res,
+                      double lambda) {
+  if (res == 0 || c.isEmpty()) return 1;
+  auto it = c.lowerBound(lambda);
+  return it == c.end() ? c.last()[res - 1] : it.value()[res - 1];
+}
+
+Reflection reflection(const Track &t, const RangeMin &min_H, int i,
+                      double lambda, const QMap<double, QVector<double>> &c,
+                      double scale) {
+  const int n = t.size();
+  const double x0 = t.x.first(), l = t.x.last() - x0;
+  const double x = t.x[i], k = (x - x0) / l;
+  const double h0 = t.h_null[i] / scale;
+
+  Reflection r;
+  r.idx = i;
+  r.l_null = (l * qSqrt(1 + h0 * h0)) / (1 + (h0 * h0) / (4 * k * (1 - k)));
+
+  // Участок отражения не длиннее четверти интервала аппроксимируется
+  // плоскостью, иначе - сферой по минимальному просвету на участке. Концы
+  // интервала не входят в участок: критический просвет в них нулевой
+  if (r.l_null <= 0.25 * l) {
+    r.delta_r = t.H[i] * t.H[i] / (2 * l * k * (1 - k));
+  } else {
+    const int b = qBound(1, lowerBound(t.x, x - r.l_null / 2), n - 2);
+    const int e =
+        qMax(b, qMin(lowerBound(t.x, x + r.l_null / 2), n - 1) - 1);
+    r.sphere = min_H.query(b, e);
+    r.delta_r = t.h_null[r.sphere] / scale;
+  }
+
+  const int begin = lowerBound(t.x, x - r.l_null);
+  const int end = qMin(lowerBound(t.x, x + r.l_null), n - 1);
+  r.phi_null = reflectionCoef(c, roughness(t, begin, end, scale), lambda);
+  r.wp = interference(r.phi_null, 6 * r.delta_r * lambda);
+  return r;
+}
+
+}  // namespace Kernel
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,368 @@
+#ifndef NRRLSKERNEL_H
+#define NRRLSKERNEL_H
+
+#include <QMap>
+#include <QPair>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
+
+namespace NRrls {
+namespace Calc {
+namespace Kernel {
+
+/**
+ * Параметры трассы для потокового расчета профиля
+ */
+struct Params {
+  double area_length = 0;        ///< Длина интервала (в метрах)
+  double lambda = 0;             ///< Длина волны
+  double equivalent_radius = 0;  ///< Эквивалентный радиус Земли
+  QPair<double, double> los = {0, 0};  ///< Уравнение ЛПВ y = a * x + b
+};
+
+/**
+ * Высотный профиль в виде непрерывных массивов
+ */
+struct Track {
+  QVector<double> x;       ///< Расстояния
+  QVector<double> y;       ///< Высоты рельефа
+  QVector<double> earth;   ///< Возвышение земной поверхности
+  QVector<double> ye;      ///< Высоты с учетом земной поверхности
+  QVector<double> los;     ///< Высота ЛПВ
+  QVector<double> H;       ///< Расстояние между ЛПВ и профилем
+  QVector<double> H_null;  ///< Критические просветы
+  QVector<double> h_null;  ///< Относительные просветы
+  QVector<double> fr_up;   ///< Верхняя дуга зоны Френеля
+  QVector<double> fr_dw;   ///< Нижняя дуга зоны Френеля
+
+  int size() const { return x.size(); }
+
+  /**
+   * Выделение памяти под рассчитываемые массивы по числу точек профиля
+   */
+  void resize(void);
+};
+
+/**
+ * Результат свертки профиля за один проход
+ */
+struct Extrema {
+  double min_H = 0;         ///< Минимальный просвет
+  double min_H_margin = 0;  ///< Минимальная разность H - H_null
+  int min_H_idx = 0;        ///< Индекс точки с минимальным просветом
+  int type = 0;  ///< Тип интервала: 1-Открытый, 2-Полуоткрытый, 3-Закрытый
+};
+
+/**
+ * Функция вычисления эквивалентного радиуса Земли
+ * @param radius  - действительный радиус Земли
+ * @param g       - вертикальный градиент индекса преломления
+ * @return Эквивалентный радиус
+ */
+inline double equivalentRadius(double radius, double g) {
+  return radius / (1 + g * radius / 2);
+}
+
+/**
+ * Функция расчета профиля за один проход: возвышение земной поверхности,
+ * высоты с ее учетом, ЛПВ, просветы H, H_null, h_null, дуги зоны Френеля и
+ * тип интервала
+ * @param p       - параметры трассы
+ * @param t       - профиль, массивы x и y должны быть заполнены
+ * @return Экстремумы просветов и тип интервала
+ */
+Extrema profilePass(const Params &p, Track &t);
+
+/**
+ * Зона Френеля, относительно которой проверяется просвет. Первая зона с
+ * долей 1 / sqrt(3) дает критический просвет H_null
+ */
+struct Zone {
+  double f = 0;         ///< Частота (в МГц)
+  int number = 1;       ///< Номер зоны Френеля
+  double fraction = 1;  ///< Доля радиуса зоны
+};
+
+/**
+ * Просветы относительно нескольких зон
+ */
+struct Clearance {
+  double min_H = 0;        ///< Минимальный просвет
+  QVector<double> margin;  ///< Минимальные разности H - R по зонам, R -
+                           ///< требуемый просвет
+  QVector<double> ratio;   ///< Минимальные отношения H / R по зонам
+  QVector<int> idx;  ///< Индексы точек с минимальным отношением
+  QVector<int> type;  ///< Типы интервала по зонам: 1-Открытый,
+                      ///< 2-Полуоткрытый, 3-Закрытый
+};
+
+/**
+ * Функция расчета профиля за один проход вместе с просветами относительно
+ * нескольких зон. Профиль рассчитывается блоками, каждый блок сворачивается
+ * по зонам, пока находится в кэше, поэтому число зон не влияет на число
+ * проходов по памяти
+ * @param p       - параметры трассы
+ * @param t       - профиль, массивы x и y должны быть заполнены
+ * @param zones   - зоны
+ * @param c       - просветы и типы интервала по зонам
+ * @return Экстремумы просветов и тип интервала
+ */
+Extrema profilePass(const Params &p, Track &t, const QVector<Zone> &zones,
+                    Clearance &c);
+
+/**
+ * Функция расчета просветов относительно нескольких зон по рассчитанному
+ * профилю. Просветы H берутся из профиля, на каждую зону приходится лишь
+ * умножение и сравнения
+ * @param p       - параметры трассы, длина волны не используется
+ * @param t       - рассчитанный профиль
+ * @param zones   - зоны
+ * @return Просветы и типы интервала по зонам
+ */
+Clearance clearance(const Params &p, const Track &t,
+                    const QVector<Zone> &zones);
+
+/**
+ * Функция определения типа интервала. Тип определяется по экстремумам
+ * просветов, профиль просматривается только в вырожденном случае нулевого
+ * минимального просвета и до первой точки, решающей исход
+ * @param e       - экстремумы просветов
+ * @param t       - рассчитанный профиль
+ * @return Тип интервала: 1-Открытый, 2-Полуоткрытый, 3-Закрытый
+ */
+int intervalType(const Extrema &e, const Track &t);
+
+/**
+ * Препятствие, пересекающее ЛПВ
+ */
+struct Obstacle {
+  int begin = 0;   ///< Индекс входа ЛПВ в препятствие
+  int end = 0;     ///< Индекс выхода ЛПВ из препятствия
+  int top = 0;     ///< Индекс вершины препятствия
+  int merged = 1;  ///< Количество исходных препятствий, замененных этим
+};
+
+/**
+ * Условие аппроксимации двух соседних препятствий одним
+ * @param l       - длина интервала
+ * @param r1      - расстояние до вершины первого препятствия
+ * @param r2      - расстояние до вершины второго препятствия
+ */
+bool mergeable(double l, double r1, double r2);
+
+/**
+ * Функция разбиения профиля на препятствия за один проход. Соседние
+ * препятствия, удовлетворяющие условию аппроксимации, заменяются одним
+ * эквивалентом
+ * @param t       - рассчитанный профиль
+ * @return Препятствия с вершинами, упорядоченные по расстоянию
+ */
+QVector<Obstacle> obstacles(const Track &t);
+
+/**
+ * Разреженная таблица для поиска экстремума на отрезке массива за O(1)
+ * после построения за O(n log n)
+ */
+template <typename Compare>
+class SparseTable {
+ public:
+  SparseTable() {}
+  explicit SparseTable(const QVector<double> &v) { assign(v); }
+
+  /**
+   * Построение таблицы для нового массива. Память прежней таблицы
+   * используется повторно, поэтому для массива того же размера не
+   * выделяется
+   * @param v       - массив, должен существовать, пока используется таблица
+   */
+  void assign(const QVector<double> &v) {
+    _v = v.constData();
+    const int n = v.size();
+    int levels = 1;
+    while ((2 << (levels - 1)) <= n) ++levels;
+    if (_t.size() != levels) _t.resize(levels);
+    _t[0].resize(n);
+    for (int i = 0; i < n; ++i) _t[0][i] = i;
+    for (int j = 1; j < levels; ++j) {
+      const int w = 1 << (j - 1);
+      _t[j].resize(n - (1 << j) + 1);
+      int *t = _t[j].data();
+      const int *p = _t[j - 1].constData();
+      for (int i = 0; i + (1 << j) <= n; ++i) t[i] = pick(p[i], p[i + w]);
+    }
+  }
+
+  /**
+   * Функция поиска экстремума
+   * @param l       - индекс начала отрезка
+   * @param r       - индекс конца отрезка (включительно)
+   * @return Индекс экстремума, при равенстве - левый
+   */
+  int query(int l, int r) const {
+    int j = 0;
+    while ((2 << j) <= r - l + 1) ++j;
+    return pick(_t[j][l], _t[j][r - (1 << j) + 1]);
+  }
+
+ private:
+  int pick(int a, int b) const { return Compare()(_v[b], _v[a]) ? b : a; }
+
+ private:
+  const double *_v = nullptr;
+  QVector<QVector<int>> _t;
+};
+
+using RangeMin = SparseTable<std::less<double>>;
+using RangeMax = SparseTable<std::greater<double>>;
+
+/**
+ * Функция поиска первого индекса, абсцисса которого не меньше заданной
+ * @param x       - упорядоченные абсциссы
+ * @param key     - искомая абсцисса
+ * @return Индекс в пределах [0, x.size()]
+ */
+inline int lowerBound(const QVector<double> &x, double key) {
+  return static_cast<int>(std::lower_bound(x.begin(), x.end(), key) -
+                          x.begin());
+}
+
+/**
+ * Точка отражения на открытом интервале
+ */
+struct Reflection {
+  int idx = 0;          ///< Индекс точки отражения
+  double l_null = 0;    ///< Длина участка отражения
+  int sphere = -1;  ///< Индекс минимального просвета на участке отражения при
+                    ///< аппроксимации сферой, -1 - аппроксимация плоскостью
+  double delta_r = 0;   ///< Разность хода прямого и отраженного лучей
+  double phi_null = 0;  ///< Коэффициент отражения
+  double wp = 0;        ///< Интерференционное затухание
+};
+
+/**
+ * Функция поиска всех пересечений высотного профиля с прямой по смене знака
+ * превышения профиля над ней
+ * @param t       - рассчитанный профиль
+ * @param line    - прямая y = a * x + b
+ * @return Индексы ближайших к пересечениям точек профиля
+ */
+QVector<int> crossings(const Track &t, const QPair<double, double> &line);
+
+/**
+ * Функция поиска пересечений профиля с прямой в заданный массив. Память
+ * массива используется повторно
+ * @param t       - рассчитанный профиль
+ * @param line    - прямая y = a * x + b
+ * @param v       - индексы ближайших к пересечениям точек профиля
+ */
+void crossings(const Track &t, const QPair<double, double> &line,
+               QVector<int> &v);
+
+/**
+ * Функция поиска точек отражения открытого интервала: пересечений профиля с
+ * прямой, соединяющей приемную антенну с точкой, зеркальной передающей
+ * антенне относительно начала профиля
+ * @param t       - рассчитанный профиль
+ * @param a       - высота передающей антенны над уровнем моря
+ * @param b       - высота приемной антенны над уровнем моря
+ * @param v       - индексы точек отражения
+ */
+void reflections(const Track &t, double a, double b, QVector<int> &v);
+
+/**
+ * Функция построения верхней выпуклой оболочки точек, упорядоченных по
+ * абсциссе (монотонная цепочка)
+ * @param x       - абсциссы, упорядоченные по возрастанию
+ * @param y       - ординаты
+ * @param begin   - индекс первой точки
+ * @param end     - индекс за последней точкой
+ * @return Индексы вершин оболочки слева направо
+ */
+QVector<int> upperHull(const QVector<double> &x, const QVector<double> &y,
+                       int begin, int end);
+
+/**
+ * Функция поиска вершины оболочки, видимой из точки под наибольшим углом
+ * возвышения: через нее проходит касательная из точки к оболочке. Точка
+ * должна лежать левее или правее всех вершин. Угол возвышения вдоль
+ * оболочки унимодален, поэтому поиск двоичный
+ * @param x       - абсциссы
+ * @param y       - ординаты
+ * @param hull    - индексы вершин верхней оболочки
+ * @param px      - абсцисса точки
+ * @param py      - ордината точки
+ * @return Индекс вершины касания в массивах x и y
+ */
+int tangent(const QVector<double> &x, const QVector<double> &y,
+            const QVector<int> &hull, double px, double py);
+
+/**
+ * Функция поиска вершины оболочки, наиболее удаленной вверх от прямой с
+ * заданным наклоном. Наклоны ребер верхней оболочки убывают, поэтому поиск
+ * двоичный
+ * @param x       - абсциссы
+ * @param y       - ординаты
+ * @param hull    - индексы вершин верхней оболочки
+ * @param slope   - наклон прямой
+ * @return Индекс вершины в массивах x и y
+ */
+int extreme(const QVector<double> &x, const QVector<double> &y,
+            const QVector<int> &hull, double slope);
+
+/**
+ * Функция определения степени неровности рельефа на участке отражения.
+ * Просветы H_null и h_null профиля могут быть рассчитаны для другой длины
+ * волны: они приводятся к нужной умножением и делением на scale
+ * @param t       - рассчитанный профиль
+ * @param begin   - индекс начальной точки участка отражения
+ * @param end     - индекс конечной точки участка отражения
+ * @param scale   - корень из отношения длин волн
+ * @return 0 - гладкий рельеф, иначе номер коэффициента отражения + 1
+ */
+int roughness(const Track &t, int begin, int end, double scale = 1);
+
+/**
+ * Функция выбора коэффициента отражения
+ * @param c       - коэффициенты отражения по длинам волн
+ * @param res     - степень неровности рельефа (roughness)
+ * @param lambda  - длина волны
+ */
+double reflectionCoef(const QMap<double, QVector<double>> &c, int res,
+                      double lambda);
+
+/**
+ * Функция расчета интерференционного затухания
+ * @param phi     - коэффициент отражения
+ * @param p2      - квадрат относительного просвета в точке отражения
+ */
+template <typename T>
+T interference(double phi, const T &p2) {
+  const double phi2 = phi * phi;
+  return -10 * log10(1 + phi2 - 2 * phi2 * qCos(2 * M_PI * p2 / 3));
+}
+
+/**
+ * Функция расчета затухания в точке отражения открытого интервала: длина
+ * участка отражения, разность хода при аппроксимации плоскостью или сферой,
+ * коэффициент отражения по неровности участка и интерференционное
+ * затухание. Профиль может быть рассчитан для другой длины волны, как в
+ * roughness
+ * @param t       - рассчитанный профиль
+ * @param min_H   - таблица минимумов просвета профиля
+ * @param i       - индекс точки отражения
+ * @param lambda  - длина волны
+ * @param c       - коэффициенты отражения по длинам волн
+ * @param scale   - корень из отношения lambda к длине волны профиля
+ * @return Параметры точки отражения
+ */
+Reflection reflection(const Track &t, const RangeMin &min_H, int i,
+                      double lambda, const QMap<double, QVector<double>> &c,
+                      double scale = 1);
+
+}  // namespace Kernel
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSKERNEL_H
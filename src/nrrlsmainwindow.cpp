@@ -130,7 +130,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->spec.p.first,
-                               _d->ui->rrs1CapacitySpinBox->value());
+                               _d->ui->rrs1CapacitySpinBox->value(),
+                               NRrls::Calc::Input::Power);
               capacityNotNull();
             }
           });
@@ -139,7 +140,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->spec.p.second,
-                               _d->ui->rrs2CapacitySpinBox->value());
+                               _d->ui->rrs2CapacitySpinBox->value(),
+                               NRrls::Calc::Input::Power);
               capacityNotNull();
             }
           });
@@ -148,7 +150,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->spec.s.first,
-                               _d->ui->rrs1SensitivitySpinBox->value());
+                               _d->ui->rrs1SensitivitySpinBox->value(),
+                               NRrls::Calc::Input::Sensitivity);
               capacityNotNull();
             }
           });
@@ -157,7 +160,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->spec.s.second,
-                               _d->ui->rrs2SensitivitySpinBox->value());
+                               _d->ui->rrs2SensitivitySpinBox->value(),
+                               NRrls::Calc::Input::Sensitivity);
               capacityNotNull();
             }
           });
@@ -166,7 +170,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->tower.c.first,
-                               _d->ui->rrs1CoefSpinBox->value());
+                               _d->ui->rrs1CoefSpinBox->value(),
+                               NRrls::Calc::Input::Gain);
               capacityNotNull();
             }
           });
@@ -175,7 +180,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->tower.c.second,
-                               _d->ui->rrs2CoefSpinBox->value());
+                               _d->ui->rrs2CoefSpinBox->value(),
+                               NRrls::Calc::Input::Gain);
               capacityNotNull();
             }
           });
@@ -184,7 +190,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->constant.g_standard,
-                               _d->ui->trackGradientSpinBox->value() * 1e-08);
+                               _d->ui->trackGradientSpinBox->value() * 1e-08,
+                               NRrls::Calc::Input::Gradient);
               capacityNotNull();
             }
           });
@@ -199,7 +206,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->constant.temperature,
-                               _d->ui->trackTemperatureSpinBox->value());
+                               _d->ui->trackTemperatureSpinBox->value(),
+                               NRrls::Calc::Input::Temperature);
               capacityNotNull();
             }
           });
@@ -208,7 +216,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->spec.prob,
-                               _d->ui->trackProbabilitySpinBox->value());
+                               _d->ui->trackProbabilitySpinBox->value(),
+                               NRrls::Calc::Input::Prob);
               capacityNotNull();
             }
           });
@@ -217,7 +226,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->tower.wf.first,
-                               _d->ui->rrs1FeederSpinBox->value());
+                               _d->ui->rrs1FeederSpinBox->value(),
+                               NRrls::Calc::Input::Feeder);
               capacityNotNull();
             }
           });
@@ -226,7 +236,8 @@ NRrlsMainWindow::NRrlsMainWindow(const QVariantMap &options, QWidget *parent)
           QOverload<double>::of(&QDoubleSpinBox::valueChanged), [&]() {
             if (_d->ui->customplot->graphCount() >= 5) {
               _d->_c->setValue(_d->_c->data->tower.wf.second,
-                               _d->ui->rrs2FeederSpinBox->value());
+                               _d->ui->rrs2FeederSpinBox->value(),
+                               NRrls::Calc::Input::Feeder);
               capacityNotNull();
             }
           });
@@ -434,6 +445,7 @@ void NRrlsMainWindow::onChangeHeight(double d) {
     QDoubleSpinBox *sp = qobject_cast<QDoubleSpinBox *>(sender());
     (sp == _d->ui->rrs1HeightSpinBox) ? _d->_c->data->tower.f.setY(d)
                                       : _d->_c->data->tower.s.setY(d);
+    _d->_c->invalidate(NRrls::Calc::Input::Heights);
     capacityNotNull();
   }
 }
@@ -464,11 +476,11 @@ void NRrlsMainWindow::onChangeRrsSpec(const QString &text) {
       capacity->setValue(_d->_c->setValueWithReturn(
           (c == _d->ui->rrs1TypeComboBox) ? _d->_c->data->spec.p.first
                                           : _d->_c->data->spec.p.second,
-          _d->_c->data->spec.stat[text][0]));
+          _d->_c->data->spec.stat[text][0], NRrls::Calc::Input::Power));
       coef->setValue(_d->_c->setValueWithReturn(
           (c == _d->ui->rrs1TypeComboBox) ? _d->_c->data->tower.c.first
                                           : _d->_c->data->tower.c.second,
-          _d->_c->data->spec.stat[text][1]));
+          _d->_c->data->spec.stat[text][1], NRrls::Calc::Input::Gain));
       capacity->setReadOnly(true);
       coef->setReadOnly(true);
       for (const auto &it : _d->_c->data->spec.j[text].keys()) j->addItem(it);
@@ -501,7 +513,8 @@ void NRrlsMainWindow::onChangeSens(const QString &text) {
       s->setValue(_d->_c->setValueWithReturn(
           (c == _d->ui->rrs1ModeSpinBox) ? _d->_c->data->spec.s.first
                                          : _d->_c->data->spec.s.second,
-          _d->_c->data->spec.j[r->currentText()][text]));
+          _d->_c->data->spec.j[r->currentText()][text],
+          NRrls::Calc::Input::Sensitivity));
       s->setReadOnly(true);
     }
 
@@ -0,0 +1,182 @@
+#include "nrrlsmontecarlo.h"
+
+#include <thread>
+
+namespace NRrls {
+namespace Calc {
+namespace MonteCarlo {
+
+namespace {
+
+/**
+ * Перемешивание SplitMix64
+ */
+quint64 mix(quint64 z) {
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Счетчиковый генератор: значение зависит только от ключа потока и номера,
+ * поэтому любая реализация воспроизводится независимо от остальных
+ */
+class Stream {
+ public:
+  Stream(quint64 seed, quint64 stream) : _key(mix(seed ^ mix(stream))) {}
+
+  /**
+   * Равномерно распределенное число в (0, 1]
+   */
+  double uniform() {
+    return ((mix(_key + _counter++) >> 11) + 1) / 9007199254740992.0;
+  }
+
+  /**
+   * Нормально распределенное число (преобразование Бокса-Мюллера)
+   */
+  double normal() {
+    if (_has_spare) {
+      _has_spare = false;
+      return _spare;
+    }
+    const double r = qSqrt(-2 * qLn(uniform()));
+    const double phi = 2 * M_PI * uniform();
+    _spare = r * qSin(phi);
+    _has_spare = true;
+    return r * qCos(phi);
+  }
+
+ private:
+  quint64 _key;
+  quint64 _counter = 0;
+  double _spare = 0;
+  bool _has_spare = false;
+};
+
+/**
+ * Рабочее место потока: копия профиля и параметров трассы, рабочие массивы
+ * расчета затухания в рельефе, используемые всеми реализациями потока
+ */
+class Worker {
+ public:
+  Worker(const Series::Link &link, const Options &o) : _link(link), _o(o) {
+    _track.x = link.track.x;
+    _track.y = link.track.y;
+    _track.resize();
+    _params = link.params;
+    _params.equivalent_radius =
+        Kernel::equivalentRadius(link.radius, o.gradient);
+
+    // Экспоненциальная корреляция: процесс авторегрессии первого порядка с
+    // коэффициентом, зависящим от шага профиля
+    const int n = _track.size();
+    _rho.resize(n);
+    _scale.resize(n);
+    for (int i = 1; i < n; ++i) {
+      const double step = link.track.x[i] - link.track.x[i - 1];
+      _rho[i] = o.length > 0 ? qExp(-step / o.length) : 0;
+      _scale[i] = qSqrt(1 - _rho[i] * _rho[i]) * o.sigma;
+    }
+  }
+
+  /**
+   * Расчет одной реализации
+   * @param r       - номер реализации
+   * @param type    - тип интервала
+   * @return Запас связи сверх требуемого
+   */
+  double exec(int r, int &type) {
+    const int n = _track.size();
+    const double *y = _link.track.y.constData();
+    const double *rho = _rho.constData(), *scale = _scale.constData();
+    double *yp = _track.y.data();
+
+    Stream s(_o.seed, r);
+    const double bias = _o.bias * s.normal();
+    // Процесс начинается со стационарного распределения в первой точке,
+    // поэтому СКО ошибки одинаково во всех внутренних точках
+    double e = _o.sigma * s.normal();
+    for (int i = 1; i + 1 < n; ++i) {
+      e = rho[i] * e + scale[i] * s.normal();
+      yp[i] = y[i] + bias + e;
+    }
+
+    type = Kernel::profilePass(_params, _track).type;
+    double wp = 0;
+    switch (type) {
+      case 1:
+        wp = Diffraction::interference(_track, _link.tx, _link.rx,
+                                       _params.lambda, _link.reflection_coef,
+                                       _w);
+        break;
+      case 2:
+        wp = Diffraction::shading(_track, _params.lambda);
+        break;
+      case 3:
+        wp = Diffraction::loss(_track, _link.tx, _link.rx, _params.lambda,
+                               _link.diffraction, _w);
+        break;
+    }
+    return _link.level - wp - _link.stock;
+  }
+
+ private:
+  const Series::Link &_link;
+  const Options &_o;
+  Kernel::Track _track;
+  Kernel::Params _params;
+  QVector<double> _rho;    ///< Коэффициенты корреляции соседних точек
+  QVector<double> _scale;  ///< СКО обновления ошибки
+  Diffraction::Workspace _w;  ///< Рабочие массивы расчета затухания
+};
+
+}  // namespace
+
+double Result::percentile(double q) const {
+  if (margin.isEmpty()) return 0;
+  const double u = qBound(0.0, q / 100, 1.0) * (margin.size() - 1);
+  const int i = qMin(static_cast<int>(u), margin.size() - 1);
+  const int j = qMin(i + 1, margin.size() - 1);
+  return margin[i] + (u - i) * (margin[j] - margin[i]);
+}
+
+Result run(const Series::Link &link, const Options &o) {
+  Result res;
+  const int n = qMax(o.realizations, 0);
+  if (!n || link.track.x.isEmpty()) return res;
+
+  int threads = o.threads > 0 ? o.threads
+                              : static_cast<int>(
+                                    std::thread::hardware_concurrency());
+  threads = qBound(1, threads, n);
+
+  res.margin.resize(n);
+  QVector<int> type(n);
+  double *margin = res.margin.data();
+  int *t = type.data();
+
+  // Реализации распределяются по потокам блоками
+  auto body = [&](int w) {
+    Worker worker(link, o);
+    const int begin = static_cast<qint64>(n) * w / threads;
+    const int end = static_cast<qint64>(n) * (w + 1) / threads;
+    for (int r = begin; r < end; ++r) margin[r] = worker.exec(r, t[r]);
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 1; w < threads; ++w) pool.emplace_back(body, w);
+  body(0);
+  for (auto &th : pool) th.join();
+
+  std::sort(res.margin.begin(), res.margin.end());
+  Sweep::Result types;
+  types.type = type;
+  res.types = Sweep::integrate(types, QVector<double>(n, 1.0));
+  return res;
+}
+
+}  // namespace MonteCarlo
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,59 @@
+#ifndef NRRLSMONTECARLO_H
+#define NRRLSMONTECARLO_H
+
+#include "nrrlsseries.h"
+#include "nrrlssweep.h"
+
+namespace NRrls {
+namespace Calc {
+namespace MonteCarlo {
+
+/**
+ * Модель ошибок высот рельефа. Ошибка в точке складывается из общего
+ * смещения профиля и случайной составляющей, коррелированной по расстоянию
+ * с экспоненциальной функцией корреляции
+ */
+struct Options {
+  double sigma = 1;       ///< СКО случайной составляющей (в метрах)
+  double length = 300;    ///< Радиус корреляции (в метрах), 0 - без корреляции
+  double bias = 0;        ///< СКО общего смещения (в метрах)
+  double gradient = -8e-8;  ///< Градиент индекса преломления (в 1/м)
+  int realizations = 1000;  ///< Число реализаций
+  quint64 seed = 1;         ///< Начальное значение генератора
+  int threads = 0;  ///< Число потоков, 0 - по числу ядер
+};
+
+/**
+ * Результат статистических испытаний
+ */
+struct Result {
+  QVector<double> margin;  ///< Запасы связи сверх требуемого по реализациям,
+                           ///< упорядоченные по возрастанию
+  Sweep::Fractions types;  ///< Доли реализаций по типам интервала
+
+  /**
+   * Функция нахождения процентиля запаса связи
+   * @param q       - процент (0...100)
+   */
+  double percentile(double q) const;
+};
+
+/**
+ * Функция статистических испытаний. Реализации распределяются по потокам,
+ * каждая реализация использует собственный поток счетчикового генератора,
+ * поэтому результат не зависит от числа потоков. Затухание в рельефе
+ * рассчитывается в каждой реализации по ее типу интервала. Массивы профиля и
+ * рабочие массивы расчета затухания выделяются один раз на поток. Высоты в
+ * концах интервала не возмущаются, во всех внутренних точках случайная
+ * составляющая имеет одно и то же СКО o.sigma
+ * @param link    - параметры интервала
+ * @param o       - модель ошибок и параметры испытаний
+ * @return Распределение запаса связи
+ */
+Result run(const Series::Link &link, const Options &o);
+
+}  // namespace MonteCarlo
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSMONTECARLO_H
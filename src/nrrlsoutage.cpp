@@ -0,0 +1,38 @@
+#include "nrrlsoutage.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Outage {
+
+Result evaluate(const Links &l) {
+  Result r;
+  const int n = l.size();
+  r.p_null.resize(n);
+  r.sesrg.resize(n);
+  r.sesrc.fill(0, n);
+  r.sesr.resize(n);
+
+  const double *f = l.f.constData(), *d = l.length.constData(),
+               *h = l.height.constData(), *q = l.margin.constData();
+  double *p_null = r.p_null.data(), *sesrg = r.sesrg.data();
+  for (int j = 0; j < n; ++j) {
+    p_null[j] = occurrence(f[j], d[j], climate(h[j]));
+    sesrg[j] = p_null[j] * qPow(10, -.1 * q[j]) / 100;
+  }
+
+  if (l.rate.size() == n) {
+    QVector<Atmosphere::Rain::Link> links(n);
+    for (int j = 0; j < n; ++j)
+      links[j] = {f[j], d[j], l.rate[j], l.tau.value(j)};
+    QVector<double> p;
+    Atmosphere::Rain::Batch(links).percentage(l.margin, p);
+    for (int j = 0; j < n; ++j) r.sesrc[j] = p[j] / 100;
+  }
+
+  for (int j = 0; j < n; ++j) r.sesr[j] = r.sesrg[j] + r.sesrc[j];
+  return r;
+}
+
+}  // namespace Outage
+}  // namespace Calc
+}  // namespace NRrls
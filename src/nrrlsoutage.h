@@ -0,0 +1,69 @@
+#ifndef NRRLSOUTAGE_H
+#define NRRLSOUTAGE_H
+
+#include "nrrlsatmosphere.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Outage {
+
+/**
+ * Функция расчета климатического коэффициента
+ * @param h       - средняя высота подвеса антенн (в метрах)
+ */
+inline double climate(double h) { return 5 - .007 * h + 4e-6 * h * h; }
+
+/**
+ * Функция расчета вероятности возникновения интерференционных замираний
+ * @param f       - частота (в ГГц)
+ * @param d       - длина интервала (в км)
+ * @param c       - климатический коэффициент
+ * @return Вероятность (в %)
+ */
+inline double occurrence(double f, double d, double c) {
+  return d > 20 ? 4.1e-4 * c * qPow(f, 1.5) * d * d
+                : 2.05e-5 * c * qPow(f, 1.5) * d * d * d;
+}
+
+/**
+ * Пакет интервалов: по массиву на каждый параметр
+ */
+struct Links {
+  QVector<double> f;       ///< Частоты (в ГГц)
+  QVector<double> length;  ///< Длины интервалов (в км)
+  QVector<double> height;  ///< Средние высоты подвеса антенн (в метрах)
+  QVector<double> margin;  ///< Запасы связи (в дБ)
+  QVector<double> rate;  ///< Интенсивности дождя, превышаемые 0,01% времени
+                         ///< (в мм/ч), пустой массив - без учета дождя
+  QVector<double> tau;  ///< Углы наклона поляризации (в градусах)
+
+  int size() const { return f.size(); }
+};
+
+/**
+ * Показатели неготовности по интервалам
+ */
+struct Result {
+  QVector<double> p_null;  ///< Вероятности интерференционных замираний
+                           ///< (в %)
+  QVector<double> sesrg;   ///< SESR из-за интерференционных замираний
+                           ///< (доля времени)
+  QVector<double> sesrc;   ///< SESR из-за дождя (доля времени)
+  QVector<double> sesr;    ///< Суммарный SESR (доля времени)
+};
+
+/**
+ * Функция расчета SESR для пакета интервалов. Составляющая от
+ * интерференционных замираний - доля времени, в течение которой глубина
+ * замирания превышает запас связи, от дождя - доля времени, в течение
+ * которой затухание в дожде превышает запас связи
+ * @param l       - интервалы
+ * @return Показатели неготовности
+ */
+Result evaluate(const Links &l);
+
+}  // namespace Outage
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSOUTAGE_H
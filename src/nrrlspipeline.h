@@ -0,0 +1,89 @@
+#ifndef NRRLSPIPELINE_H
+#define NRRLSPIPELINE_H
+
+namespace NRrls {
+namespace Calc {
+
+/**
+ * Цепочка составляющих расчета, заданная на этапе компиляции списком типов.
+ * Составляющая создается на стеке над общим контекстом и должна иметь
+ * конструктор от ссылки на контекст, статическую функцию inputs() с набором
+ * флагов Input::Flag и функцию bool exec(). Вызовы составляющих не
+ * виртуальные, поэтому компилятор может встраивать их друг в друга
+ */
+template <typename... Stages>
+struct Pipeline;
+
+template <>
+struct Pipeline<> {
+  static constexpr int inputs() { return 0; }
+
+  template <typename Context>
+  static bool exec(Context &) {
+    return true;
+  }
+
+  template <typename Context, typename Before>
+  static bool exec(Context &, Before &&) {
+    return true;
+  }
+
+  template <typename Context, typename Before>
+  static bool update(Context &, int, Before &&) {
+    return true;
+  }
+};
+
+template <typename Stage, typename... Rest>
+struct Pipeline<Stage, Rest...> {
+  /**
+   * Входные параметры, от которых зависит хотя бы одна составляющая
+   */
+  static constexpr int inputs() {
+    return Stage::inputs() | Pipeline<Rest...>::inputs();
+  }
+
+  /**
+   * Запуск всех составляющих по порядку
+   * @param c       - контекст расчета
+   * @return Признак завершения расчета
+   */
+  template <typename Context>
+  static bool exec(Context &c) {
+    return Stage(c).exec() && Pipeline<Rest...>::exec(c);
+  }
+
+  /**
+   * Запуск всех составляющих по порядку
+   * @param c       - контекст расчета
+   * @param before  - функция, вызываемая перед каждой составляющей с ее
+   *                  входными параметрами
+   * @return Признак завершения расчета
+   */
+  template <typename Context, typename Before>
+  static bool exec(Context &c, Before &&before) {
+    before(Stage::inputs());
+    return Stage(c).exec() && Pipeline<Rest...>::exec(c, before);
+  }
+
+  /**
+   * Перезапуск цепочки с первой составляющей, зависящей от измененных
+   * параметров. Все последующие составляющие перезапускаются, так как
+   * зависят от ее результатов
+   * @param c       - контекст расчета
+   * @param changed - набор флагов Input::Flag
+   * @param before  - функция, вызываемая перед каждой составляющей с ее
+   *                  входными параметрами
+   * @return Признак завершения расчета
+   */
+  template <typename Context, typename Before>
+  static bool update(Context &c, int changed, Before &&before) {
+    if (Stage::inputs() & changed) return exec(c, before);
+    return Pipeline<Rest...>::update(c, changed, before);
+  }
+};
+
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSPIPELINE_H
@@ -0,0 +1,187 @@
+#include "nrrlsrefraction.h"
+
+#include <algorithm>
+
+namespace NRrls {
+namespace Calc {
+namespace Refraction {
+
+namespace {
+
+/**
+ * Функция поиска ближайшего пересечения параболы h + th * s + c * s^2 / 2 с
+ * уровнем, отстоящим на dh = h - уровень
+ * @return Расстояние до пересечения или HUGE_VAL. Касание и нулевой корень
+ * (луч начинается на уровне) пересечением не считаются
+ */
+double crossing(double dh, double th, double c) {
+  const double a = c / 2;
+  if (a == 0) {
+    if (th == 0) return HUGE_VAL;
+    const double s = -dh / th;
+    return s > 0 ? s : HUGE_VAL;
+  }
+
+  const double d = th * th - 4 * a * dh;
+  if (d <= 0) return HUGE_VAL;
+
+  const double q = -(th + std::copysign(qSqrt(d), th)) / 2;
+  const double s1 = q / a;
+  const double s2 = q != 0 ? dh / q : HUGE_VAL;
+  double s = HUGE_VAL;
+  if (s1 > 0) s = s1;
+  if (s2 > 0 && s2 < s) s = s2;
+  return s;
+}
+
+/**
+ * Состояние луча
+ */
+struct Ray {
+  double x;
+  double h;
+  double th;  ///< Угол места
+  int k;      ///< Слой
+};
+
+/**
+ * Продвижение луча до абсциссы x
+ */
+void advance(const Profile &p, Ray &r, double x) {
+  double s = x - r.x;
+  while (s > 0) {
+    const double c = p.curvature(r.k);
+    const double lo = crossing(r.h - p.lower(r.k), r.th, c);
+    const double hi = crossing(r.h - p.upper(r.k), r.th, c);
+    const double e = qMin(lo, hi);
+
+    if (e >= s) {
+      r.h += (r.th + c * s / 2) * s;
+      r.th += c * s;
+      break;
+    }
+
+    // Луч выходит из слоя: переход в соседний с точным значением высоты
+    r.th += c * e;
+    s -= e;
+    if (hi < lo)
+      r.h = p.upper(r.k++);
+    else
+      r.h = p.lower(r.k--);
+  }
+  r.x = x;
+}
+
+}  // namespace
+
+Profile::Profile(const QVector<Level> &levels, double radius) {
+  const int n = levels.size();
+  for (int i = 1; i + 1 < n; ++i) _bounds.push_back(levels[i].h);
+  for (int i = 0; i + 1 < n; ++i) {
+    const double g =
+        (levels[i + 1].n - levels[i].n) / (levels[i + 1].h - levels[i].h);
+    _c.push_back(g * 1e-6 + 1 / radius);
+  }
+  if (_c.isEmpty()) _c.push_back(1 / radius);
+}
+
+Profile Profile::linear(double g, double radius) {
+  Profile p;
+  p._c.push_back(g * 1e-6 + 1 / radius);
+  return p;
+}
+
+int Profile::layer(double h) const {
+  return std::upper_bound(_bounds.begin(), _bounds.end(), h) -
+         _bounds.begin();
+}
+
+void trace(const Profile &p, const Point &a, const QVector<double> &angles,
+           const QVector<double> &x, QVector<double> &h) {
+  const int na = angles.size(), nx = x.size();
+  h.resize(na * nx);
+
+  QVector<Ray> rays(na);
+  const int k = p.layer(a.h);
+  for (int i = 0; i < na; ++i) rays[i] = {a.x, a.h, angles[i], k};
+
+  for (int j = 0; j < nx; ++j)
+    for (int i = 0; i < na; ++i) {
+      advance(p, rays[i], x[j]);
+      h[i * nx + j] = rays[i].h;
+    }
+}
+
+QVector<double> connect(const Profile &p, const Point &a, const Point &b,
+                        const QVector<double> &x) {
+  const int fan = 32;
+  const QVector<double> end(1, b.x);
+
+  // Начальный веер вокруг угла на прямую видимость с шириной, охватывающей
+  // искривление луча в волноводах (до 0,5 * 1e-6 1/м)
+  const double d = b.x - a.x;
+  const double width = 2.5e-7 * d + 1e-3;
+  double th_lo = (b.h - a.h) / d - width;
+  double th_hi = (b.h - a.h) / d + width;
+
+  QVector<double> angles(fan), h;
+  double best = (th_lo + th_hi) / 2;
+  for (int round = 0; round < 5; ++round) {
+    const double step = (th_hi - th_lo) / (fan - 1);
+    for (int i = 0; i < fan; ++i) angles[i] = th_lo + step * i;
+    trace(p, a, angles, end, h);
+
+    // Высота в приемной точке растет с углом места; берется нижний из лучей,
+    // проходящих через приемник, и ближайший при их отсутствии
+    int i = 0;
+    while (i + 1 < fan && !((h[i] - b.h) * (h[i + 1] - b.h) <= 0)) ++i;
+    if (i + 1 == fan) {
+      i = 0;
+      for (int l = 1; l < fan; ++l)
+        if (qAbs(h[l] - b.h) < qAbs(h[i] - b.h)) i = l;
+      best = angles[i];
+      th_lo = angles[qMax(i - 1, 0)];
+      th_hi = angles[qMin(i + 1, fan - 1)];
+      continue;
+    }
+
+    const double w = h[i + 1] != h[i] ? (b.h - h[i]) / (h[i + 1] - h[i]) : 0;
+    best = angles[i] + w * step;
+    th_lo = angles[i];
+    th_hi = angles[i + 1];
+  }
+
+  trace(p, a, QVector<double>(1, best), x, h);
+  return h;
+}
+
+Kernel::Extrema clearance(const Profile &p, const Point &a, const Point &b,
+                          double lambda, Kernel::Track &t) {
+  Kernel::Extrema e;
+  const int n = t.size();
+  t.resize();
+  if (n < 2) return e;
+
+  t.los = connect(p, a, b, t.x);
+  const double x0 = t.x.first(), l = t.x.last() - x0;
+  e.min_H = HUGE_VAL;
+  e.min_H_margin = HUGE_VAL;
+  for (int i = 0; i < n; ++i) {
+    const double k = (t.x[i] - x0) / l;
+    t.earth[i] = 0;
+    t.ye[i] = t.y[i];
+    t.H[i] = t.los[i] - t.y[i];
+    t.H_null[i] = qSqrt(qMax(l * lambda * k * (1 - k) / 3, 0.0));
+    t.h_null[i] = t.H[i] / t.H_null[i];
+    t.fr_up[i] = t.los[i] - t.H_null[i];
+    t.fr_dw[i] = t.los[i] + t.H_null[i];
+    if (t.H[i] < e.min_H) e.min_H = t.H[i], e.min_H_idx = i;
+    e.min_H_margin = qMin(e.min_H_margin, t.H[i] - t.H_null[i]);
+  }
+  e.type = Kernel::intervalType(e, t);
+  return e;
+}
+
+}  // namespace Refraction
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,127 @@
+#ifndef NRRLSREFRACTION_H
+#define NRRLSREFRACTION_H
+
+#include <QVector>
+#include <QtMath>
+
+#include "nrrlskernel.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Refraction {
+
+/**
+ * Уровень профиля индекса преломления (радиозондирования)
+ */
+struct Level {
+  double h;  ///< Высота над уровнем моря (в метрах)
+  double n;  ///< Индекс преломления (в N-единицах)
+};
+
+/**
+ * Слоистый профиль индекса преломления. Между уровнями индекс меняется
+ * линейно, ниже первого и выше последнего уровня продолжается с градиентом
+ * крайнего слоя. Профиль хранится как модифицированный индекс M = N +
+ * h / radius * 1e6, в котором Земля плоская, а луч в каждом слое
+ * распространяется по параболе
+ */
+class Profile {
+ public:
+  /**
+   * @param levels  - уровни, упорядоченные по высоте (не менее двух)
+   * @param radius  - действительный радиус Земли (в метрах)
+   */
+  explicit Profile(const QVector<Level> &levels, double radius = 6.37e+06);
+
+  /**
+   * Профиль с постоянным градиентом
+   * @param g       - вертикальный градиент индекса преломления (в N/м)
+   * @param radius  - действительный радиус Земли (в метрах)
+   */
+  static Profile linear(double g, double radius = 6.37e+06);
+
+  int layers() const { return _c.size(); }
+
+  /**
+   * Функция определения слоя, содержащего высоту
+   */
+  int layer(double h) const;
+
+  /**
+   * Нижняя и верхняя границы слоя (бесконечные у крайних слоев)
+   */
+  double lower(int k) const { return k > 0 ? _bounds[k - 1] : -HUGE_VAL; }
+  double upper(int k) const {
+    return k < _bounds.size() ? _bounds[k] : HUGE_VAL;
+  }
+
+  /**
+   * Кривизна луча в слое относительно плоской Земли (в 1/м)
+   */
+  double curvature(int k) const { return _c[k]; }
+
+ private:
+  Profile() {}
+
+ private:
+  QVector<double> _bounds;  ///< Границы между слоями
+  QVector<double> _c;       ///< Кривизна луча по слоям
+};
+
+/**
+ * Точка трассы
+ */
+struct Point {
+  double x;  ///< Расстояние (в метрах)
+  double h;  ///< Высота над уровнем моря (в метрах)
+};
+
+/**
+ * Функция трассировки пучка лучей. Лучи ведутся одновременно от одной
+ * абсциссы к следующей, шаг внутри слоя выбирается до ближайшей точки вывода
+ * или пересечения границы слоя, на котором решение точное. Высоты лучей
+ * отсчитываются от сферической Земли и сравниваются с высотами рельефа без
+ * поправки на ее кривизну
+ * @param p       - профиль индекса преломления
+ * @param a       - точка излучения
+ * @param angles  - углы места лучей (в радианах)
+ * @param x       - абсциссы вывода, упорядоченные по возрастанию, не левее a
+ * @param h       - высоты лучей: h[i * x.size() + j] для луча i в точке j
+ */
+void trace(const Profile &p, const Point &a, const QVector<double> &angles,
+           const QVector<double> &x, QVector<double> &h);
+
+/**
+ * Функция поиска луча, соединяющего две точки. Угол места уточняется
+ * веерами лучей, трассируемых до приемной точки
+ * @param p       - профиль индекса преломления
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param x       - абсциссы вывода
+ * @return Высоты луча в точках x
+ */
+QVector<double> connect(const Profile &p, const Point &a, const Point &b,
+                        const QVector<double> &x);
+
+/**
+ * Функция расчета просветов относительно луча, соединяющего антенны, вместо
+ * ЛПВ над Землей эквивалентного радиуса. Луч находится функцией connect,
+ * просветы отсчитываются от высот рельефа без поправки на кривизну Земли,
+ * тип интервала определяется, как в Kernel::intervalType
+ * @param p       - профиль индекса преломления
+ * @param a       - передающая антенна
+ * @param b       - приемная антенна
+ * @param lambda  - длина волны
+ * @param t       - профиль, массивы x и y должны быть заполнены; в los
+ *                  записываются высоты луча, в H, H_null, h_null, fr_up и
+ *                  fr_dw - просветы и зона Френеля относительно луча
+ * @return Экстремумы просветов и тип интервала
+ */
+Kernel::Extrema clearance(const Profile &p, const Point &a, const Point &b,
+                          double lambda, Kernel::Track &t);
+
+}  // namespace Refraction
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSREFRACTION_H
@@ -0,0 +1,189 @@
+#include "nrrlsseries.h"
+#include "nrrlssweep.h"
+
+#include <QFile>
+#include <QTextStream>
+
+namespace NRrls {
+namespace Calc {
+namespace Series {
+
+namespace {
+
+/**
+ * Шаг, с которым различаются градиенты (в 1/м): 1 N-единица на км
+ */
+const double gradient_step = 1e-9;
+
+/**
+ * Число узлов сетки градиента для расчета затухания в рельефе
+ */
+const int wp_nodes_count = 33;
+
+}  // namespace
+
+bool read(const QString &filename, QVector<Sample> &samples) {
+  QTextStream estream(stderr);
+  QFile file(filename);
+  samples.clear();
+
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    estream << QString("Could not open file %1\n").arg(filename);
+    return false;
+  }
+
+  QTextStream in(&file);
+  int t = -1, g = -1, h = -1;
+  QString line = in.readLine().toLower();
+  for (int i = 0; !line.section(";", i, i).isNull(); ++i) {
+    if (line.section(";", i, i).contains("температура"))
+      t = i;
+    else if (line.section(";", i, i).contains("градиент"))
+      g = i;
+    else if (line.section(";", i, i).contains("влажность"))
+      h = i;
+  }
+  if (t == -1 || g == -1 || h == -1) {
+    estream << QString("File %1 doesn't contain table names\n").arg(filename);
+    return false;
+  }
+
+  samples.reserve(8760);
+  while (!in.atEnd()) {
+    line = in.readLine();
+    if (line.trimmed().isEmpty()) continue;
+    line.replace(",", ".");
+    samples.push_back({line.section(";", t, t).toDouble(),
+                       line.section(";", g, g).toDouble() * 1e-8,
+                       line.section(";", h, h).toDouble()});
+  }
+  file.close();
+
+  if (samples.isEmpty()) {
+    estream << QString("File %1 is empty\n").arg(filename);
+    return false;
+  }
+  return true;
+}
+
+Result evaluate(const Link &link, const QVector<Sample> &samples) {
+  Result r;
+  const int n = samples.size();
+  if (!n) return r;
+
+  // Различные градиенты и номер градиента для каждого часа
+  QVector<double> g(n);
+  for (int i = 0; i < n; ++i)
+    g[i] = qRound(samples[i].gradient / gradient_step) * gradient_step;
+  QVector<double> unique = g;
+  std::sort(unique.begin(), unique.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+  // Тип интервала для всех градиентов за один проход по профилю
+  const Sweep::Result sweep =
+      Sweep::gradients(link.params, link.track, unique, link.radius);
+
+  // Затухание в рельефе для градиента g и типа интервала type
+  Kernel::Track track = link.track;
+  Kernel::Params params = link.params;
+  Diffraction::Workspace w;
+  auto relief = [&](double g, int type) {
+    params.equivalent_radius = Kernel::equivalentRadius(link.radius, g);
+    Kernel::profilePass(params, track);
+    switch (type) {
+      case 1:
+        return Diffraction::interference(track, link.tx, link.rx,
+                                         params.lambda, link.reflection_coef,
+                                         w);
+      case 2:
+        return Diffraction::shading(track, params.lambda);
+      case 3:
+        return Diffraction::loss(track, link.tx, link.rx, params.lambda,
+                                 link.diffraction, w);
+    }
+    return 0.0;
+  };
+
+  // Затухание на закрытом и полуоткрытом интервале непрерывно по градиенту и
+  // рассчитывается в узлах равномерных сеток, охватывающих закрытые и
+  // полуоткрытые часы
+  struct Grid {
+    double lo = HUGE_VAL;
+    double step = 0;
+    QVector<double> wp;
+  };
+  auto grid = [&](int type) {
+    Grid gr;
+    double hi = -HUGE_VAL;
+    for (int j = 0; j < unique.size(); ++j)
+      if (sweep.type[j] == type)
+        gr.lo = qMin(gr.lo, unique[j]), hi = qMax(hi, unique[j]);
+    if (gr.lo > hi) return gr;
+
+    const int nodes = hi > gr.lo ? wp_nodes_count : 1;
+    gr.step = (hi - gr.lo) / (wp_nodes_count - 1);
+    for (int k = 0; k < nodes; ++k)
+      gr.wp.push_back(relief(gr.lo + gr.step * k, type));
+    return gr;
+  };
+  auto interpolate = [](const Grid &gr, double g) {
+    if (gr.wp.size() == 1) return gr.wp[0];
+    const double u = (g - gr.lo) / gr.step;
+    const int k = qMin(static_cast<int>(u), gr.wp.size() - 2);
+    return gr.wp[k] + (u - k) * (gr.wp[k + 1] - gr.wp[k]);
+  };
+  const Grid closed = grid(3), semi_opened = grid(2);
+
+  // Интерференционное затухание на открытом интервале осциллирует по
+  // градиенту, поэтому рассчитывается для каждого градиента
+  QVector<double> wp(unique.size(), 0);
+  for (int j = 0; j < unique.size(); ++j) {
+    switch (sweep.type[j]) {
+      case 1:
+        wp[j] = relief(unique[j], 1);
+        break;
+      case 2:
+        wp[j] = interpolate(semi_opened, unique[j]);
+        break;
+      case 3:
+        wp[j] = interpolate(closed, unique[j]);
+        break;
+    }
+  }
+
+  const Atmosphere::Table::Slice gamma =
+      Atmosphere::Table::instance().slice(link.f);
+  const double length = link.params.area_length / 1000.0;
+  Atmosphere::Conditions c;
+  c.pressure = link.pressure;
+
+  r.margin.resize(n);
+  r.type.resize(n);
+  r.min_margin = HUGE_VAL;
+  int run = 0;
+  for (int i = 0; i < n; ++i) {
+    const int j =
+        std::lower_bound(unique.begin(), unique.end(), g[i]) - unique.begin();
+    c.temperature = samples[i].temperature;
+    c.humidity = samples[i].humidity;
+    const double wa = length * gamma(c);
+
+    r.type[i] = sweep.type[j];
+    r.margin[i] = link.level - wp[j] - wa - link.stock;
+    r.min_margin = qMin(r.min_margin, r.margin[i]);
+
+    if (r.margin[i] < 0) {
+      ++r.outage;
+      if (!run++) ++r.events;
+      r.longest = qMax(r.longest, run);
+    } else {
+      run = 0;
+    }
+  }
+  r.unavailability = static_cast<double>(r.outage) / n;
+  return r;
+}
+
+}  // namespace Series
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,80 @@
+#ifndef NRRLSSERIES_H
+#define NRRLSSERIES_H
+
+#include <QString>
+
+#include "nrrlsatmosphere.h"
+#include "nrrlsdiffraction.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Series {
+
+/**
+ * Почасовая запись метеоданных
+ */
+struct Sample {
+  double temperature;  ///< Температура (в градусах Цельсия)
+  double gradient;  ///< Вертикальный градиент индекса преломления (в 1/м)
+  double humidity;  ///< Плотность водяного пара (в г/м3)
+};
+
+/**
+ * Функция чтения метеоданных из файла. Файл в формате профиля: первая строка
+ * содержит названия столбцов "Температура", "Градиент" и "Влажность",
+ * разделитель ";". Градиент задается в единицах 1e-8 1/м, как в окне
+ * программы
+ * @param filename  - имя файла
+ * @param samples   - записи, по одной на строку
+ * @return Признак успешного чтения
+ */
+bool read(const QString &filename, QVector<Sample> &samples);
+
+/**
+ * Параметры интервала, не зависящие от погоды
+ */
+struct Link {
+  Kernel::Params params;  ///< Параметры трассы, equivalent_radius не
+                          ///< используется
+  Kernel::Track track;    ///< Профиль, массивы x и y должны быть заполнены
+  double radius = 6.37e+06;  ///< Действительный радиус Земли
+  Diffraction::Point tx = {0, 0};  ///< Передающая антенна
+  Diffraction::Point rx = {0, 0};  ///< Приемная антенна
+  Diffraction::Options diffraction;  ///< Параметры расчета дифракции
+  double f = 0;               ///< Частота (в ГГц)
+  double pressure = 1013.25;  ///< Атмосферное давление (в гПа)
+  double level = 0;  ///< Запас связи без затуханий в рельефе и газах
+  QMap<double, QVector<double>> reflection_coef;  ///< Коэффициенты отражения
+  double stock = 0;  ///< Требуемый запас связи
+};
+
+/**
+ * Результат почасового расчета
+ */
+struct Result {
+  QVector<double> margin;  ///< Запас связи сверх требуемого по часам
+  QVector<int> type;  ///< Тип интервала по часам
+  int outage = 0;     ///< Число часов без связи
+  int events = 0;     ///< Число перерывов связи
+  int longest = 0;    ///< Наибольшая длительность перерыва (в часах)
+  double unavailability = 0;  ///< Доля времени без связи
+  double min_margin = 0;      ///< Наименьший запас связи
+};
+
+/**
+ * Функция почасового расчета запаса связи. Тип интервала определяется для
+ * каждого различного градиента, затухание в рельефе на закрытом и
+ * полуоткрытом интервале - в узлах сетки по градиенту, на открытом - для
+ * каждого различного градиента, затухание в газах - по таблице для каждого
+ * часа
+ * @param link    - параметры интервала
+ * @param samples - метеоданные
+ * @return Запас связи по часам и статистика перерывов
+ */
+Result evaluate(const Link &link, const QVector<Sample> &samples);
+
+}  // namespace Series
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSSERIES_H
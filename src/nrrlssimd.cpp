@@ -0,0 +1,284 @@
+#include "nrrlssimd.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define NRRLS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace NRrls {
+namespace Calc {
+namespace Kernel {
+namespace Simd {
+
+Coef::Coef(const Params &p, double x0)
+    : x0(x0),
+      half(p.area_length / 2),
+      inv_2r(1 / (2 * p.equivalent_radius)),
+      inv_l(1 / p.area_length),
+      zone(p.area_length * p.lambda / 3),
+      a(p.los.first),
+      b(p.los.second) {}
+
+namespace {
+
+/**
+ * Скалярный расчет. Эталон для векторных вариантов и обработка хвостов
+ */
+void profileScalar(const Coef &c, Track &t, int begin, int end, Reduce &r) {
+  const double *x = t.x.constData();
+  const double *y = t.y.constData();
+  double *earth = t.earth.data(), *ye = t.ye.data(), *los = t.los.data(),
+         *H = t.H.data(), *H_null = t.H_null.data(),
+         *h_null = t.h_null.data(), *fr_up = t.fr_up.data(),
+         *fr_dw = t.fr_dw.data();
+
+  for (int i = begin; i < end; ++i) {
+    const double d = x[i] - c.x0;
+    const double m = d - c.half;
+    const double k = d * c.inv_l;
+
+    earth[i] = (c.half * c.half - m * m) * c.inv_2r;
+    ye[i] = y[i] + earth[i];
+    los[i] = c.a * x[i] + c.b;
+    H[i] = los[i] - ye[i];
+    H_null[i] = qSqrt(qMax(c.zone * k * (1 - k), 0.0));
+    h_null[i] = H[i] / H_null[i];
+    fr_up[i] = los[i] - H_null[i];
+    fr_dw[i] = los[i] + H_null[i];
+
+    if (H[i] < r.min_H) r.min_H = H[i], r.min_H_idx = i;
+    r.min_H_margin = qMin(r.min_H_margin, H[i] - H_null[i]);
+  }
+}
+
+#ifdef NRRLS_SIMD_X86
+
+/**
+ * Слияние минимумов по дорожкам вектора. При равенстве берется меньший
+ * индекс, как в скалярном расчете
+ */
+void mergeLanes(const double *min_H, const double *idx, const double *margin,
+                int lanes, Reduce &r) {
+  for (int l = 0; l < lanes; ++l) {
+    if (min_H[l] < r.min_H ||
+        (min_H[l] == r.min_H && static_cast<int>(idx[l]) < r.min_H_idx))
+      r.min_H = min_H[l], r.min_H_idx = static_cast<int>(idx[l]);
+    r.min_H_margin = qMin(r.min_H_margin, margin[l]);
+  }
+}
+
+__attribute__((target("avx2"))) void profileAvx2(const Coef &c, Track &t,
+                                                 int begin, int end,
+                                                 Reduce &r) {
+  const double *x = t.x.constData();
+  const double *y = t.y.constData();
+  double *earth = t.earth.data(), *ye = t.ye.data(), *los = t.los.data(),
+         *H = t.H.data(), *H_null = t.H_null.data(),
+         *h_null = t.h_null.data(), *fr_up = t.fr_up.data(),
+         *fr_dw = t.fr_dw.data();
+
+  const __m256d x0 = _mm256_set1_pd(c.x0), half = _mm256_set1_pd(c.half),
+                hh = _mm256_set1_pd(c.half * c.half),
+                inv_2r = _mm256_set1_pd(c.inv_2r),
+                inv_l = _mm256_set1_pd(c.inv_l), zone = _mm256_set1_pd(c.zone),
+                a = _mm256_set1_pd(c.a), b = _mm256_set1_pd(c.b),
+                one = _mm256_set1_pd(1), zero = _mm256_setzero_pd(),
+                step = _mm256_set1_pd(4);
+
+  __m256d v_min = _mm256_set1_pd(HUGE_VAL), v_margin = v_min,
+          v_min_idx = zero, v_idx = _mm256_set_pd(3, 2, 1, 0);
+
+  int i = begin;
+  v_idx = _mm256_add_pd(v_idx, _mm256_set1_pd(begin));
+  for (; i + 4 <= end; i += 4) {
+    const __m256d vx = _mm256_loadu_pd(x + i);
+    const __m256d d = _mm256_sub_pd(vx, x0);
+    const __m256d m = _mm256_sub_pd(d, half);
+    const __m256d k = _mm256_mul_pd(d, inv_l);
+
+    const __m256d ve =
+        _mm256_mul_pd(_mm256_sub_pd(hh, _mm256_mul_pd(m, m)), inv_2r);
+    const __m256d vye = _mm256_add_pd(_mm256_loadu_pd(y + i), ve);
+    const __m256d vlos = _mm256_add_pd(_mm256_mul_pd(a, vx), b);
+    const __m256d vH = _mm256_sub_pd(vlos, vye);
+    const __m256d vHn = _mm256_sqrt_pd(_mm256_max_pd(
+        _mm256_mul_pd(_mm256_mul_pd(zone, k), _mm256_sub_pd(one, k)), zero));
+
+    _mm256_storeu_pd(earth + i, ve);
+    _mm256_storeu_pd(ye + i, vye);
+    _mm256_storeu_pd(los + i, vlos);
+    _mm256_storeu_pd(H + i, vH);
+    _mm256_storeu_pd(H_null + i, vHn);
+    _mm256_storeu_pd(h_null + i, _mm256_div_pd(vH, vHn));
+    _mm256_storeu_pd(fr_up + i, _mm256_sub_pd(vlos, vHn));
+    _mm256_storeu_pd(fr_dw + i, _mm256_add_pd(vlos, vHn));
+
+    const __m256d less = _mm256_cmp_pd(vH, v_min, _CMP_LT_OQ);
+    v_min = _mm256_blendv_pd(v_min, vH, less);
+    v_min_idx = _mm256_blendv_pd(v_min_idx, v_idx, less);
+    v_margin = _mm256_min_pd(v_margin, _mm256_sub_pd(vH, vHn));
+    v_idx = _mm256_add_pd(v_idx, step);
+  }
+
+  double l_min[4], l_idx[4], l_margin[4];
+  _mm256_storeu_pd(l_min, v_min);
+  _mm256_storeu_pd(l_idx, v_min_idx);
+  _mm256_storeu_pd(l_margin, v_margin);
+  mergeLanes(l_min, l_idx, l_margin, 4, r);
+
+  profileScalar(c, t, i, end, r);
+}
+
+__attribute__((target("avx512f"))) void profileAvx512(const Coef &c,
+                                                      Track &t, int begin,
+                                                      int end, Reduce &r) {
+  const double *x = t.x.constData();
+  const double *y = t.y.constData();
+  double *earth = t.earth.data(), *ye = t.ye.data(), *los = t.los.data(),
+         *H = t.H.data(), *H_null = t.H_null.data(),
+         *h_null = t.h_null.data(), *fr_up = t.fr_up.data(),
+         *fr_dw = t.fr_dw.data();
+
+  const __m512d x0 = _mm512_set1_pd(c.x0), half = _mm512_set1_pd(c.half),
+                hh = _mm512_set1_pd(c.half * c.half),
+                inv_2r = _mm512_set1_pd(c.inv_2r),
+                inv_l = _mm512_set1_pd(c.inv_l), zone = _mm512_set1_pd(c.zone),
+                a = _mm512_set1_pd(c.a), b = _mm512_set1_pd(c.b),
+                one = _mm512_set1_pd(1), zero = _mm512_setzero_pd(),
+                step = _mm512_set1_pd(8);
+
+  __m512d v_min = _mm512_set1_pd(HUGE_VAL), v_margin = v_min,
+          v_min_idx = zero,
+          v_idx = _mm512_add_pd(_mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0),
+                                _mm512_set1_pd(begin));
+
+  int i = begin;
+  for (; i + 8 <= end; i += 8) {
+    const __m512d vx = _mm512_loadu_pd(x + i);
+    const __m512d d = _mm512_sub_pd(vx, x0);
+    const __m512d m = _mm512_sub_pd(d, half);
+    const __m512d k = _mm512_mul_pd(d, inv_l);
+
+    const __m512d ve =
+        _mm512_mul_pd(_mm512_sub_pd(hh, _mm512_mul_pd(m, m)), inv_2r);
+    const __m512d vye = _mm512_add_pd(_mm512_loadu_pd(y + i), ve);
+    const __m512d vlos = _mm512_add_pd(_mm512_mul_pd(a, vx), b);
+    const __m512d vH = _mm512_sub_pd(vlos, vye);
+    const __m512d vHn = _mm512_sqrt_pd(_mm512_max_pd(
+        _mm512_mul_pd(_mm512_mul_pd(zone, k), _mm512_sub_pd(one, k)), zero));
+
+    _mm512_storeu_pd(earth + i, ve);
+    _mm512_storeu_pd(ye + i, vye);
+    _mm512_storeu_pd(los + i, vlos);
+    _mm512_storeu_pd(H + i, vH);
+    _mm512_storeu_pd(H_null + i, vHn);
+    _mm512_storeu_pd(h_null + i, _mm512_div_pd(vH, vHn));
+    _mm512_storeu_pd(fr_up + i, _mm512_sub_pd(vlos, vHn));
+    _mm512_storeu_pd(fr_dw + i, _mm512_add_pd(vlos, vHn));
+
+    const __mmask8 less = _mm512_cmp_pd_mask(vH, v_min, _CMP_LT_OQ);
+    v_min = _mm512_mask_blend_pd(less, v_min, vH);
+    v_min_idx = _mm512_mask_blend_pd(less, v_min_idx, v_idx);
+    v_margin = _mm512_min_pd(v_margin, _mm512_sub_pd(vH, vHn));
+    v_idx = _mm512_add_pd(v_idx, step);
+  }
+
+  double l_min[8], l_idx[8], l_margin[8];
+  _mm512_storeu_pd(l_min, v_min);
+  _mm512_storeu_pd(l_idx, v_min_idx);
+  _mm512_storeu_pd(l_margin, v_margin);
+  mergeLanes(l_min, l_idx, l_margin, 8, r);
+
+  profileScalar(c, t, i, end, r);
+}
+
+/**
+ * Сравнение двух массивов с допуском tolerance
+ */
+bool near(const QVector<double> &lhs, const QVector<double> &rhs) {
+  for (int i = 0; i < lhs.size(); ++i) {
+    if (lhs[i] == rhs[i] || (std::isnan(lhs[i]) && std::isnan(rhs[i])))
+      continue;
+    if (qAbs(lhs[i] - rhs[i]) > tolerance * qMax(1.0, qAbs(lhs[i])))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Проверка векторного расчета на контрольном профиле
+ */
+bool selfTest(Isa isa) {
+  const int n = 203;  ///< Не кратно ширине вектора, чтобы проверить хвост
+  Params p;
+  p.area_length = 30.0 * (n - 1);
+  p.lambda = .3;
+  p.equivalent_radius = equivalentRadius(6.37e+06, -8e-8);
+  p.los = {.001, 120};
+
+  Track ref, vec;
+  for (int i = 0; i < n; ++i) {
+    ref.x.push_back(30.0 * i);
+    ref.y.push_back(100 + 25 * qSin(i * .1) + (i % 7));
+  }
+  vec.x = ref.x, vec.y = ref.y;
+  ref.resize(), vec.resize();
+
+  const Coef c(p, ref.x.first());
+  Reduce r_ref, r_vec;
+  profileScalar(c, ref, 0, n, r_ref);
+  profile(isa, c, vec, 0, n, r_vec);
+
+  return near(ref.earth, vec.earth) && near(ref.ye, vec.ye) &&
+         near(ref.los, vec.los) && near(ref.H, vec.H) &&
+         near(ref.H_null, vec.H_null) && near(ref.h_null, vec.h_null) &&
+         near(ref.fr_up, vec.fr_up) && near(ref.fr_dw, vec.fr_dw) &&
+         r_ref.min_H_idx == r_vec.min_H_idx &&
+         qAbs(r_ref.min_H_margin - r_vec.min_H_margin) <=
+             tolerance * qMax(1.0, qAbs(r_ref.min_H_margin));
+}
+
+#endif  // NRRLS_SIMD_X86
+
+Isa detect(void) {
+#ifdef NRRLS_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && selfTest(Isa::Avx512))
+    return Isa::Avx512;
+  if (__builtin_cpu_supports("avx2") && selfTest(Isa::Avx2)) return Isa::Avx2;
+#endif
+  return Isa::Scalar;
+}
+
+}  // namespace
+
+Isa isa(void) {
+  static const Isa selected = detect();
+  return selected;
+}
+
+void profile(const Coef &c, Track &t, int begin, int end, Reduce &r) {
+  profile(isa(), c, t, begin, end, r);
+}
+
+void profile(Isa isa, const Coef &c, Track &t, int begin, int end,
+             Reduce &r) {
+  switch (isa) {
+#ifdef NRRLS_SIMD_X86
+    case Isa::Avx512:
+      profileAvx512(c, t, begin, end, r);
+      break;
+    case Isa::Avx2:
+      profileAvx2(c, t, begin, end, r);
+      break;
+#endif
+    default:
+      profileScalar(c, t, begin, end, r);
+  }
+}
+
+}  // namespace Simd
+}  // namespace Kernel
+}  // namespace Calc
+}  // namespace NRrls
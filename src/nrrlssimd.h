@@ -0,0 +1,73 @@
+#ifndef NRRLSSIMD_H
+#define NRRLSSIMD_H
+
+#include "nrrlskernel.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Kernel {
+namespace Simd {
+
+/**
+ * Набор команд, которым выполняется расчет профиля
+ */
+enum class Isa { Scalar, Avx2, Avx512 };
+
+/**
+ * Допустимое относительное расхождение векторного расчета со скалярным
+ */
+const double tolerance = 1e-9;
+
+/**
+ * Коэффициенты расчета профиля, общие для всех точек
+ */
+struct Coef {
+  double x0 = 0;      ///< Абсцисса начала интервала
+  double half = 0;    ///< Половина длины интервала
+  double inv_2r = 0;  ///< 1 / (2 * эквивалентный радиус)
+  double inv_l = 0;   ///< 1 / длина интервала
+  double zone = 0;    ///< Длина интервала * lambda / 3
+  double a = 0;       ///< y = a * x + b (ЛПВ)
+  double b = 0;       ///< y = a * x + b (ЛПВ)
+
+  Coef() {}
+  Coef(const Params &p, double x0);
+};
+
+/**
+ * Частичная свертка профиля
+ */
+struct Reduce {
+  double min_H = HUGE_VAL;         ///< Минимальный просвет
+  double min_H_margin = HUGE_VAL;  ///< Минимальная разность H - H_null
+  int min_H_idx = 0;  ///< Индекс точки с минимальным просветом
+};
+
+/**
+ * Функция определения набора команд процессора. Векторный расчет выбирается,
+ * только если на контрольном профиле он совпадает со скалярным в пределах
+ * tolerance
+ * @return Набор команд
+ */
+Isa isa(void);
+
+/**
+ * Функция расчета профиля в точках [begin, end) выбранным набором команд
+ * @param c       - коэффициенты расчета
+ * @param t       - профиль, массивы должны быть выделены
+ * @param r       - свертка, дополняется результатами
+ */
+void profile(const Coef &c, Track &t, int begin, int end, Reduce &r);
+
+/**
+ * Функция расчета профиля заданным набором команд
+ */
+void profile(Isa isa, const Coef &c, Track &t, int begin, int end,
+             Reduce &r);
+
+}  // namespace Simd
+}  // namespace Kernel
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSSIMD_H
@@ -0,0 +1,83 @@
+#include "nrrlsstock.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Stock {
+
+namespace {
+
+const int f_nodes = 257;  ///< Число узлов по частоте
+const int t_nodes = 512;  ///< Число узлов по проценту времени
+const double t_min = 1e-4;  ///< Наименьший процент времени
+const double t_max = 50;    ///< Наибольший процент времени
+
+/**
+ * Запас по зависимости для процента t, за пределами зависимости -
+ * значение в крайней точке
+ */
+double value(const Curve &c, double t) {
+  if (t <= c.first().y()) return c.first().x();
+  for (int i = 1; i < c.size(); ++i) {
+    if (t > c[i].y()) continue;
+    const QPointF &l = c[i - 1], &r = c[i];
+    return l.x() + (r.x() - l.x()) * (t - l.y()) / (r.y() - l.y());
+  }
+  return c.last().x();
+}
+
+}  // namespace
+
+Table::Table(const QMap<double, Curve> &depend) {
+  if (depend.isEmpty()) return;
+
+  const double f_lo = log10(depend.firstKey()), f_hi = log10(depend.lastKey());
+  _f = {f_lo, f_hi > f_lo ? (f_hi - f_lo) / (f_nodes - 1) : 1, f_nodes};
+  _t = {log10(t_min), (log10(t_max) - log10(t_min)) / (t_nodes - 1), t_nodes};
+  _stock.resize(_f.n * _t.n);
+
+  QVector<double> lf;
+  QVector<Curve> curves;
+  for (auto it = depend.begin(); it != depend.end(); ++it) {
+    lf.push_back(log10(it.key()));
+    curves.push_back(it.value());
+  }
+
+  for (int i = 0, k = 0; i < _f.n; ++i) {
+    // Зависимости на частотах по обе стороны от узла
+    const double u = qMin(_f.value(i), f_hi);
+    while (k + 2 < lf.size() && lf[k + 1] < u) ++k;
+    const int r = qMin(k + 1, lf.size() - 1);
+    const double w = r > k ? qBound(0.0, (u - lf[k]) / (lf[r] - lf[k]), 1.0)
+                           : 0;
+    for (int j = 0; j < _t.n; ++j) {
+      const double t = qPow(10, _t.value(j));
+      _stock[i * _t.n + j] =
+          (1 - w) * value(curves[k], t) + w * value(curves[r], t);
+    }
+  }
+}
+
+IA::Interval Table::operator()(const IA::Interval &f, double t) const {
+  double lo = (*this)(f.lo(), t), hi = lo;
+  const double v = (*this)(f.hi(), t);
+  lo = qMin(lo, v);
+  hi = qMax(hi, v);
+
+  // Узлы сетки внутри интервала частот
+  double wt;
+  const int ti = _t.locate(log10(qMax(t, 1e-12)), wt);
+  const double a = log10(qMax(f.lo(), 1e-6)), b = log10(qMax(f.hi(), 1e-6));
+  const int first = qMax(0, qCeil((a - _f.min) / _f.step));
+  const int last = qMin(_f.n - 1, qFloor((b - _f.min) / _f.step));
+  for (int i = first; i <= last; ++i) {
+    const double *s = _stock.constData() + i * _t.n + ti;
+    const double u = (1 - wt) * s[0] + wt * s[1];
+    lo = qMin(lo, u);
+    hi = qMax(hi, u);
+  }
+  return IA::Interval(lo, hi);
+}
+
+}  // namespace Stock
+}  // namespace Calc
+}  // namespace NRrls
@@ -0,0 +1,82 @@
+#ifndef NRRLSSTOCK_H
+#define NRRLSSTOCK_H
+
+#include <QMap>
+#include <QPointF>
+
+#include "nrrlsatmosphere.h"
+#include "nrrlsinterval.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Stock {
+
+/**
+ * Зависимость процента времени от запаса связи: точки (запас, процент),
+ * упорядоченные по возрастанию процента
+ */
+typedef QVector<QPointF> Curve;
+
+/**
+ * Таблица требуемого запаса связи на сетке частота x процент времени.
+ * Строится один раз по зависимостям для отдельных частот: между точками
+ * зависимости запас интерполируется линейно по проценту, между частотами -
+ * линейно по логарифму частоты. Запас на промежуточных значениях находится
+ * билинейной интерполяцией без ветвлений, частота и процент ограничиваются
+ * пределами сетки. Погрешность в изломах зависимостей - сотые доли дБ
+ */
+class Table {
+ public:
+  Table() {}
+
+  /**
+   * Построение таблицы
+   * @param depend  - зависимости процента времени от запаса по частотам
+   *                  (в МГц)
+   */
+  explicit Table(const QMap<double, Curve> &depend);
+
+  /**
+   * Функция нахождения требуемого запаса связи
+   * @param f       - частота (в МГц)
+   * @param t       - процент времени, в течение которого допускается
+   *                  перерыв связи
+   * @return Запас (в дБ)
+   */
+  double operator()(double f, double t) const {
+    double wf, wt;
+    const int fi = _f.locate(log10(qMax(f, 1e-6)), wf);
+    const int ti = _t.locate(log10(qMax(t, 1e-12)), wt);
+    const double *v = _stock.constData() + fi * _t.n + ti;
+    return (1 - wf) * ((1 - wt) * v[0] + wt * v[1]) +
+           wf * ((1 - wt) * v[_t.n] + wt * v[_t.n + 1]);
+  }
+
+  /**
+   * Функция нахождения границ требуемого запаса связи при частоте, заданной
+   * интервалом. Между узлами сетки запас линеен по логарифму частоты,
+   * поэтому границы - наименьшее и наибольшее значение в концах интервала
+   * и в узлах внутри него
+   * @param f       - частота (в МГц)
+   * @param t       - процент времени, в течение которого допускается
+   *                  перерыв связи
+   * @return Границы запаса (в дБ)
+   */
+  IA::Interval operator()(const IA::Interval &f, double t) const;
+
+  bool isEmpty() const { return _stock.isEmpty(); }
+
+ private:
+  typedef Atmosphere::Table::Axis Axis;
+
+  Axis _f = {0, 1, 0};  ///< Десятичный логарифм частоты (в МГц)
+  Axis _t = {0, 1, 0};  ///< Десятичный логарифм процента времени
+  QVector<double> _stock;  ///< Запасы: _stock[i * _t.n + j] для частоты i и
+                           ///< процента j
+};
+
+}  // namespace Stock
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSSTOCK_H
@@ -0,0 +1,121 @@
+#include "nrrlssweep.h"
+#include "nrrlssimd.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Sweep {
+
+Result gradients(const Kernel::Params &p, const Kernel::Track &t,
+                 const QVector<double> &g, double radius) {
+  Result r;
+  const int n = t.size(), m = g.size();
+  r.g = g;
+  r.min_H.fill(HUGE_VAL, m);
+  r.min_H_margin.fill(HUGE_VAL, m);
+  r.min_H_idx.fill(0, m);
+  r.type.fill(0, m);
+  if (!n) return r;
+
+  // Возвышение земной поверхности равно bulge[i] / (2 * R), поэтому
+  // градиенты различаются только множителем 1 / (2 * R)
+  QVector<double> inv_2r(m);
+  for (int j = 0; j < m; ++j)
+    inv_2r[j] = 1 / (2 * Kernel::equivalentRadius(radius, g[j]));
+
+  const Kernel::Simd::Coef c(p, t.x.first());
+  QVector<double> clear(n), bulge(n), H_null(n);
+  const double *x = t.x.constData(), *y = t.y.constData();
+  const double *k2r = inv_2r.constData();
+  double *min_H = r.min_H.data(), *min_margin = r.min_H_margin.data();
+  int *min_idx = r.min_H_idx.data();
+
+  for (int i = 0; i < n; ++i) {
+    const double d = x[i] - c.x0;
+    const double mid = d - c.half;
+    const double k = d * c.inv_l;
+    clear[i] = c.a * x[i] + c.b - y[i];
+    bulge[i] = c.half * c.half - mid * mid;
+    H_null[i] = i + 1 < n ? qSqrt(qMax(c.zone * k * (1 - k), 0.0)) : 0;
+
+    const double cl = clear[i], bu = bulge[i], hn = H_null[i];
+    for (int j = 0; j < m; ++j) {
+      const double H = cl - bu * k2r[j];
+      if (H < min_H[j]) min_H[j] = H, min_idx[j] = i;
+      min_margin[j] = qMin(min_margin[j], H - hn);
+    }
+  }
+
+  for (int j = 0; j < m; ++j) {
+    if (min_H[j] < 0)
+      r.type[j] = 3;
+    else if (min_margin[j] >= 0)
+      r.type[j] = 1;
+    else if (min_H[j] > 0)
+      r.type[j] = 2;
+    else {
+      // Нулевой минимальный просвет, как в Kernel::intervalType
+      bool opened = false;
+      for (int i = 0; i < n && !r.type[j]; ++i) {
+        const double H = clear[i] - bulge[i] * k2r[j];
+        if (H > 0 && H < H_null[i]) r.type[j] = 2;
+        opened = opened || H >= H_null[i];
+      }
+      if (!r.type[j]) r.type[j] = opened ? 1 : 0;
+    }
+  }
+  return r;
+}
+
+Distribution normal(double mean, double sigma, int n) {
+  Distribution d;
+  if (n < 2 || sigma <= 0) {
+    d.g = {mean};
+    d.w = {1};
+    return d;
+  }
+
+  const double step = 8 * sigma / (n - 1);
+  double sum = 0;
+  for (int i = 0; i < n; ++i) {
+    const double g = mean - 4 * sigma + step * i;
+    d.g.push_back(g);
+    d.w.push_back(qExp(-qPow((g - mean) / sigma, 2) / 2));
+    sum += d.w.last();
+  }
+  for (auto &w : d.w) w /= sum;
+  return d;
+}
+
+Fractions integrate(const Result &r, const QVector<double> &w) {
+  Fractions f;
+  double sum = 0;
+  for (int j = 0; j < r.type.size(); ++j) {
+    sum += w[j];
+    switch (r.type[j]) {
+      case 1:
+        f.opened += w[j];
+        break;
+      case 2:
+        f.semi_opened += w[j];
+        break;
+      case 3:
+        f.closed += w[j];
+        break;
+    }
+  }
+  if (sum > 0) {
+    f.opened /= sum;
+    f.semi_opened /= sum;
+    f.closed /= sum;
+  }
+  return f;
+}
+
+Fractions integrate(const Kernel::Params &p, const Kernel::Track &t,
+                    const Distribution &d, double radius) {
+  return integrate(gradients(p, t, d.g, radius), d.w);
+}
+
+}  // namespace Sweep
+}  // namespace Calc
+}  // namespace NRrls
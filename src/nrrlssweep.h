@@ -0,0 +1,80 @@
+#ifndef NRRLSSWEEP_H
+#define NRRLSSWEEP_H
+
+#include "nrrlskernel.h"
+
+namespace NRrls {
+namespace Calc {
+namespace Sweep {
+
+/**
+ * Просветы и типы интервала для набора градиентов
+ */
+struct Result {
+  QVector<double> g;             ///< Градиенты индекса преломления
+  QVector<double> min_H;         ///< Минимальные просветы
+  QVector<double> min_H_margin;  ///< Минимальные разности H - H_null
+  QVector<int> min_H_idx;  ///< Индексы точек с минимальным просветом
+  QVector<int> type;  ///< Типы интервала: 1-Открытый, 2-Полуоткрытый,
+                      ///< 3-Закрытый
+};
+
+/**
+ * Функция расчета профиля для набора градиентов за один проход. Высоты
+ * рельефа, ЛПВ и критические просветы читаются и рассчитываются один раз на
+ * точку, от градиента зависит только возвышение земной поверхности
+ * @param p       - параметры трассы, equivalent_radius не используется
+ * @param t       - профиль, массивы x и y должны быть заполнены
+ * @param g       - градиенты индекса преломления
+ * @param radius  - действительный радиус Земли
+ * @return Экстремумы просветов и типы интервала по градиентам
+ */
+Result gradients(const Kernel::Params &p, const Kernel::Track &t,
+                 const QVector<double> &g, double radius);
+
+/**
+ * Дискретное распределение градиента
+ */
+struct Distribution {
+  QVector<double> g;  ///< Значения градиента
+  QVector<double> w;  ///< Вероятности значений
+};
+
+/**
+ * Функция дискретизации нормального распределения градиента
+ * @param mean    - среднее значение
+ * @param sigma   - стандартное отклонение
+ * @param n       - число значений в пределах mean +- 4 * sigma
+ * @return Распределение с нормированными вероятностями
+ */
+Distribution normal(double mean, double sigma, int n);
+
+/**
+ * Доли времени, в течение которых интервал имеет данный тип
+ */
+struct Fractions {
+  double opened = 0;
+  double semi_opened = 0;
+  double closed = 0;
+};
+
+/**
+ * Функция расчета долей времени по типам интервала
+ * @param r       - результат расчета для значений распределения
+ * @param w       - вероятности значений
+ * @return Доли времени
+ */
+Fractions integrate(const Result &r, const QVector<double> &w);
+
+/**
+ * Функция расчета долей времени по типам интервала для распределения
+ * градиента
+ */
+Fractions integrate(const Kernel::Params &p, const Kernel::Track &t,
+                    const Distribution &d, double radius);
+
+}  // namespace Sweep
+}  // namespace Calc
+}  // namespace NRrls
+
+#endif  // NRRLSSWEEP_H